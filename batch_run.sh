@@ -7,18 +7,43 @@ batch=1000
 max_croaring_many=4096
 seed=100
 
+# Generate the workload datasets once; C and Perl both read them
+echo "Generating datasets..."
+for len in "${bitlen[@]}"; do
+    ./benchmark dataset "$len" "$seed"
+done
+
 # Run against perl alternatives
 echo "Running Perl benchmarks..."
 for len in "${bitlen[@]}"; do
     echo "Running Perl benchmark with bitlen=$len"
-    perlbrew exec --with bitperl ./bench_bit_vector_cpan.pl -bitlen="$len" -iters="$iter" -batch="$batch"
+    perlbrew exec --with bitperl ./bench_bit_vector_cpan.pl -bitlen="$len" -iters="$iter" -batch="$batch" -dataset="datasets/dataset_Length${len}_Seed${seed}.bin"
 done
 
 # Run against c alternatives
 echo "Running C benchmarks..."
 for len in "${bitlen[@]}"; do
     echo "Running C benchmark with bitlen=$len"
-    ./benchmark "$len" "$iter" "$batch" "$max_croaring_many" "$seed"
+    BENCH_SCHEDULE=block BENCH_DATASET="datasets/dataset_Length${len}_Seed${seed}.bin" ./benchmark "$len" "$iter" "$batch" "$max_croaring_many" "$seed"
+done
+
+# Decompose per-call cost into C kernel and XS/FFI glue
+echo "Running glue overhead benchmarks..."
+for len in "${bitlen[@]}"; do
+    echo "Running glue overhead benchmark with bitlen=$len"
+    perlbrew exec --with bitperl ./bench_glue_overhead.pl -bitlen="$len" -iters="$iter" -batch="$batch"
+done
+
+# Huge-page and alignment experiments for large bit vectors; Bit_T's own
+# allocations are moved onto huge pages through glibc's malloc tunable
+memlen=(1048576 16777216 268435456)
+membatch=50
+echo "Running memory backing benchmarks..."
+for len in "${memlen[@]}"; do
+    for tunables in "" "glibc.malloc.hugetlb=1" "glibc.malloc.hugetlb=2"; do
+        echo "Running memory benchmark with bitlen=$len GLIBC_TUNABLES=$tunables"
+        GLIBC_TUNABLES="$tunables" ./benchmark memory "$len" "$iter" "$membatch" "$seed"
+    done
 done
 
 echo "All benchmarks completed."
\ No newline at end of file
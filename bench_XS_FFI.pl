@@ -4,9 +4,12 @@ use v5.38;
 use base 'sealed';
 use sealed 'debug';
 
+use Alien::Bit;
 use Benchmark::CSV;
 use Bit::Set ':all';
 use Bit::Set::OO;
+use FFI::Platypus 2.00;
+use FFI::Platypus::Buffer qw(scalar_to_buffer);
 use File::Spec;
 use Getopt::Long;
 use POSIX 'dup2';
@@ -54,6 +57,32 @@ my @indices2 = ( 0 .. $bitveclen / 2 );
 my @indices3 = ( 0 .. $bitveclen / 4 );
 my @indices4 = ( 0 .. $bitveclen / 8 );
 
+# Packed index input: Bit::Set only accepts array refs, whose elements are
+# converted one SV at a time before Bit_aset runs. The bindings below hand a
+# pack('L*') string (or the raw pointer to its buffer) straight to Bit_aset of
+# the same libbit, so no per-element conversion takes place. The
+# CreateAset*_FFIArrayRef control rows pass the array ref through the same
+# binding (Bit_new, Bit_aset, Bit_free all via FFI), so against them the
+# packed rows differ only in how the indices are handed over. These rows do
+# not depend on -mode.
+my ($libbit) = grep { /libbit\.so/ } Alien::Bit->dynamic_libs;
+die "Could not locate libbit.so through Alien::Bit\n" unless defined $libbit;
+my $ffi = FFI::Platypus->new( api => 2, lib => [$libbit] );
+$ffi->attach( [ Bit_new  => 'BitPacked::Bit_new' ]  => ['int'] => 'opaque' );
+$ffi->attach( [ Bit_free => 'BitPacked::Bit_free' ] => ['opaque*'] );
+$ffi->attach(
+    [ Bit_aset => 'BitPacked::Bit_aset_packed' ] => [ 'opaque', 'string', 'int' ] );
+$ffi->attach(
+    [ Bit_aset => 'BitPacked::Bit_aset_buffer' ] => [ 'opaque', 'opaque', 'int' ] );
+$ffi->attach(
+    [ Bit_aset => 'BitPacked::Bit_aset_array' ] => [ 'opaque', 'int[]', 'int' ] );
+
+my @packed = map { pack( 'L*', @$_ ) }
+  ( \@indices1, \@indices2, \@indices3, \@indices4 );
+my @packed_len = map { length($_) / 4 } @packed;
+my @packed_ptr = map { ( scalar_to_buffer($_) )[0] } @packed;
+my @index_refs = ( \@indices1, \@indices2, \@indices3, \@indices4 );
+
 my %benchmarks = (
     "CreateSetPut_OO" => sub {
         my $b = Bit::Set->new($bitveclen);
@@ -144,6 +173,66 @@ my %benchmarks = (
         Bit_aset( $b, \@indices4 );
         Bit_free( \$b );
     },
+    "CreateAset100pct_FFIArrayRef" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_array( $b, $index_refs[0], $packed_len[0] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset100pct_PackedStr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_packed( $b, $packed[0], $packed_len[0] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset100pct_PackedPtr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_buffer( $b, $packed_ptr[0], $packed_len[0] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset50pct_FFIArrayRef" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_array( $b, $index_refs[1], $packed_len[1] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset50pct_PackedStr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_packed( $b, $packed[1], $packed_len[1] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset50pct_PackedPtr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_buffer( $b, $packed_ptr[1], $packed_len[1] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset25pct_FFIArrayRef" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_array( $b, $index_refs[2], $packed_len[2] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset25pct_PackedStr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_packed( $b, $packed[2], $packed_len[2] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset25pct_PackedPtr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_buffer( $b, $packed_ptr[2], $packed_len[2] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset12.5pct_FFIArrayRef" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_array( $b, $index_refs[3], $packed_len[3] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset12.5pct_PackedStr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_packed( $b, $packed[3], $packed_len[3] );
+        BitPacked::Bit_free( \$b );
+    },
+    "CreateAset12.5pct_PackedPtr" => sub {
+        my $b = BitPacked::Bit_new($bitveclen);
+        BitPacked::Bit_aset_buffer( $b, $packed_ptr[3], $packed_len[3] );
+        BitPacked::Bit_free( \$b );
+    },
 );
 
 ## Benchmarks
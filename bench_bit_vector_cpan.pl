@@ -20,13 +20,21 @@ my $curr_dir      = File::Spec->curdir();
 my $benchmark_dir = File::Spec->catdir( $curr_dir, 'results' );
 mkdir $benchmark_dir unless -d $benchmark_dir;
 
-my @opts = qw/bitlen=i iters=i outfile=s batch=i g_seed=i/;
+# section kinds of the dataset files written by `./benchmark dataset`
+use constant {
+    DATASET_RAND_IDX  => 1,
+    DATASET_OPERAND_A => 3,
+    DATASET_OPERAND_B => 4,
+};
+
+my @opts = qw/bitlen=i iters=i outfile=s batch=i g_seed=i dataset=s/;
 my $o    = h2o {
     bitlen  => 16384,
     iters   => 10,
     outfile => 'benchmark_bitvectors_',
     batch   => 10,
     g_seed  => 100,
+    dataset => '',
   },
   opt2h2o(@opts);
 Getopt::Long::GetOptionsFromArray( \@ARGV, $o, @opts );
@@ -38,37 +46,61 @@ my $outfname  = File::Spec->catfile( $benchmark_dir,
     $o->outfile . "LangPerl_Length${bitveclen}_Batch${batch}_CPU${cpu}.csv" );
 my $g_seed = $o->g_seed;
 
+# With -dataset the bit positions come from the file shared with the C
+# harness instead of gen_bit_positions, so both fill the same bits, and the
+# operands of PopCount/Inter/InterCount are its OPERAND_A/OPERAND_B bitmaps.
+my $dataset = length $o->dataset ? load_dataset( $o->dataset ) : undef;
+if ($dataset) {
+    die "Dataset " . $o->dataset . " was generated for bit length "
+      . $dataset->bitveclen . ", not $bitveclen\n"
+      unless $dataset->bitveclen == $bitveclen;
+    $g_seed = $dataset->seed;
+}
+
 say "Benchmarking operation in Bit::Vector, Bit::Set, and Bit::Set::OO with "
   . "bit length $bitveclen for $iters iterations and outputting to $outfname,"
   . " using random seed $g_seed in perl $^V";
 
-my @bit_positions = @{ gen_bit_positions( $bitveclen, $g_seed ) };
+my @bit_positions =
+  $dataset
+  ? unpack( 'L*', $dataset->section->{ DATASET_RAND_IDX() } )
+  : @{ gen_bit_positions( $bitveclen, $g_seed ) };
 
-# Create two operand bit vectors for bitwise operations
+# Create two operand bit vectors for bitwise operations: the two halves of
+# the vector, or the dataset's operand bitmaps. Bit::Vector loads those with
+# Block_Store and the other libraries are filled from its index lists.
+
+# Bit::Vector
+my $bv1 = Bit::Vector->new($bitveclen);
+my $bv2 = Bit::Vector->new($bitveclen);
+if ($dataset) {
+    $bv1->Block_Store( dataset_operand( $dataset, DATASET_OPERAND_A ) );
+    $bv2->Block_Store( dataset_operand( $dataset, DATASET_OPERAND_B ) );
+}
+else {
+    $bv1->Interval_Fill( 0, $bitveclen / 2 );
+    $bv2->Interval_Fill( $bitveclen / 2, $bitveclen - 1 );
+}
+my @operand1 = $bv1->Index_List_Read();
+my @operand2 = $bv2->Index_List_Read();
 
 # Bit::Set
 my $bs1 = Bit_new($bitveclen);
-Bit_set( $bs1, 0, $bitveclen / 2 );
+Bit_aset( $bs1, \@operand1 );
 my $bs2 = Bit_new($bitveclen);
-Bit_set( $bs2, $bitveclen / 2, $bitveclen - 1 );
+Bit_aset( $bs2, \@operand2 );
 
 # Bit::Set::OO
 my $bso1 = Bit::Set->new($bitveclen);
-$bso1->set( 0, $bitveclen / 2 );
+$bso1->aset( \@operand1 );
 my $bso2 = Bit::Set->new($bitveclen);
-$bso2->set( $bitveclen / 2, $bitveclen - 1 );
-
-# Bit::Vector
-my $bv1 = Bit::Vector->new($bitveclen);
-$bv1->Interval_Fill( 0, $bitveclen / 2 );
-my $bv2 = Bit::Vector->new($bitveclen);
-$bv2->Interval_Fill( $bitveclen / 2, $bitveclen - 1 );
+$bso2->aset( \@operand2 );
 
 # Lucy::Object::BitVector
 my $lobv1 = Lucy::Object::BitVector->new( capacity => $bitveclen );
-$lobv1->set($_) for 0 .. ( $bitveclen / 2 );
+$lobv1->set($_) for @operand1;
 my $lobv2 = Lucy::Object::BitVector->new( capacity => $bitveclen );
-$lobv2->set($_) for ( $bitveclen / 2 ) .. ( $bitveclen - 1 );
+$lobv2->set($_) for @operand2;
 
 my %benchmarks = (
     'Bit::Vector_new' => sub {
@@ -177,6 +209,16 @@ is(
     $lucyobjectbitvector_inter_count,
     'Bit::Vector and Lucy::Object::BitVector intersection counts match'
 );
+if ($dataset) {
+    my $bv_positions = Bit::Vector->new($bitveclen);
+    $bv_positions->Index_List_Store(@bit_positions);
+    ok( $bv_positions->equal($bv1),
+        'Dataset operand A matches its bit positions' );
+    ok( $bv_positions->equal($bv2),
+        'Dataset operand B matches its bit positions' );
+    is( Bit_count($bs1), $bv1->Norm(),
+        'Bit::Set operand holds the dataset operand bits' );
+}
 done_testing();
 
 ## Benchmarks
@@ -207,6 +249,46 @@ sub gen_bit_positions ( $bitveclen, $seed ) {
     return \@pos;                                  # return arrayref
 }
 
+# Reads a dataset written by `./benchmark dataset` (layout documented in
+# benchmark_helper.h) into a single packed buffer and returns its bit length,
+# seed and the packed payload of every section, keyed by section kind.
+sub load_dataset ($path) {
+    open my $fh, '<:raw', $path or die "Cannot open dataset $path: $!\n";
+    my $buf = do { local $/; <$fh> };
+    close $fh;
+    die "Dataset $path is truncated\n" if length($buf) < 40;
+
+    my ( $magic, $version, $endian, $bitveclen, $seed, $nsections ) =
+      unpack( 'a8 L L Q Q L', $buf );
+    die "$path is not a benchmark dataset\n" unless $magic eq 'BITBENCH';
+    die "Dataset $path was written with a different byte order\n"
+      unless $endian == 0x01020304;
+    die "Dataset $path has unsupported version $version\n"
+      unless $version == 1;
+
+    my %section;
+    for my $i ( 0 .. $nsections - 1 ) {
+        my ( $kind, $elem_size, $count, $offset ) =
+          unpack( 'L L Q Q', substr( $buf, 40 + 24 * $i, 24 ) );
+        die "Dataset $path: section $i lies outside the file\n"
+          if $offset + $elem_size * $count > length($buf);
+        $section{$kind} //= substr( $buf, $offset, $elem_size * $count );
+    }
+    return h2o {
+        bitveclen => $bitveclen,
+        seed      => $seed,
+        section   => \%section,
+    };
+}
+
+# Bytes of an operand bitmap section that cover the bit length, in the
+# little-endian bit order Block_Store expects.
+sub dataset_operand ( $dataset, $kind ) {
+    my $bits = $dataset->section->{$kind}
+      // die "Dataset has no operand bitmap of kind $kind\n";
+    return substr( $bits, 0, ( $dataset->bitveclen + 7 ) >> 3 );
+}
+
 =pod
 # execute as 
 perl -e '@bitlen=(128,256,512,1024,2048,4096,8192,16384,32768,65536,131072,262144); system("./bench_bit_vector_cpan.pl","-bitlen=$_","-iters=100",-"batch=1000") for @bitlen;'
@@ -0,0 +1,194 @@
+#!/home/chrisarg/perl5/perlbrew/perls/bitperl/bin/perl
+use v5.38;
+
+use Alien::Bit;
+use Bit::Set qw(:all);
+use FFI::Platypus 2.00;
+use File::Spec;
+use Getopt::Long;
+use List::Util qw(sum);
+use Sys::Info;
+use Sys::Info::Constants qw( :device_cpu );
+use Time::HiRes qw(clock_gettime CLOCK_MONOTONIC);
+use Util::H2O::More      qw(opt2h2o h2o);
+
+# Decomposes the cost of a Bit::Set call into the C kernel and the glue around
+# it: every operation is timed through direct C (glue_bench.c, one FFI call per
+# measurement so the loop runs entirely in C), the XS procedural API of
+# Bit::Set, and an FFI::Platypus binding to the very same libbit that Bit::Set
+# links against. XS - C and FFI - C are the per-call marshalling overheads.
+
+my $info = Sys::Info->new;
+my $cpu  = $info->device( CPU => 1 )->identify;
+
+my $curr_dir      = File::Spec->curdir();
+my $benchmark_dir = File::Spec->catdir( $curr_dir, 'results_glue' );
+mkdir $benchmark_dir unless -d $benchmark_dir;
+
+my @opts = qw/bitlen=i iters=i outfile=s batch=i/;
+my $o    = h2o {
+    bitlen  => 16384,
+    iters   => 10,
+    outfile => 'benchmark_glue',
+    batch   => 100000,
+  },
+  opt2h2o(@opts);
+Getopt::Long::GetOptionsFromArray( \@ARGV, $o, @opts );
+
+my $bitveclen = $o->bitlen;
+my $iters     = $o->iters;
+my $batch     = $o->batch;
+my $outfname  = File::Spec->catfile( $benchmark_dir,
+    $o->outfile . "_Length${bitveclen}_Batch${batch}_CPU${cpu}.csv" );
+
+# the shared libbit used by Bit::Set
+my ($libbit) = grep { /libbit\.so/ } Alien::Bit->dynamic_libs;
+die "Could not locate libbit.so through Alien::Bit\n" unless defined $libbit;
+
+say "Benchmarking per-call glue overhead (C, XS, FFI) for bit length "
+  . "$bitveclen, $iters iterations of $batch calls, outputting to $outfname "
+  . "using $libbit in perl $^V";
+
+# FFI::Platypus binding to libbit, attached the same way Bit::Set 0.10 did
+my $ffi = FFI::Platypus->new( api => 2, lib => [$libbit] );
+$ffi->type( 'opaque' => 'Bit_T' );
+$ffi->attach( [ Bit_new         => 'GlueFFI::Bit_new' ] => ['int'] => 'Bit_T' );
+$ffi->attach( [ Bit_free        => 'GlueFFI::Bit_free' ] => ['opaque*'] );
+$ffi->attach( [ Bit_get => 'GlueFFI::Bit_get' ] => [ 'Bit_T', 'int' ] => 'int' );
+$ffi->attach( [ Bit_bset => 'GlueFFI::Bit_bset' ] => [ 'Bit_T', 'int' ] );
+$ffi->attach(
+    [ Bit_aset => 'GlueFFI::Bit_aset' ] => [ 'Bit_T', 'int[]', 'int' ] );
+$ffi->attach( [ Bit_inter_count => 'GlueFFI::Bit_inter_count' ] =>
+      [ 'Bit_T', 'Bit_T' ] => 'int' );
+
+# direct C reference kernels
+my $glue_lib = File::Spec->rel2abs('libgluebench.so');
+die "Build $glue_lib with 'make libgluebench.so' first\n" unless -e $glue_lib;
+my $cffi = FFI::Platypus->new( api => 2, lib => [$glue_lib] );
+my $c_open = $cffi->function( glue_open => [ 'string', 'int' ] => 'int' );
+my %c_kernel = (
+    get  => $cffi->function( glue_c_get  => [ 'int', 'int' ] => 'double' ),
+    bset => $cffi->function( glue_c_bset => [ 'int', 'int' ] => 'double' ),
+    aset => $cffi->function( glue_c_aset => [ 'int', 'int', 'int' ] => 'double' ),
+    inter_count =>
+      $cffi->function( glue_c_inter_count => [ 'int', 'int' ] => 'double' ),
+);
+$c_open->call( $libbit, $batch ) == 0 or die "glue_open failed\n";
+
+# Bit_aset argument sizes: powers of 4 up to the bit length
+my @aset_sizes;
+for ( my $n = 1 ; $n <= $bitveclen ; $n *= 4 ) { push @aset_sizes, $n }
+
+# operand sets for the Perl side
+my $xs1 = Bit_new($bitveclen);
+my $xs2 = Bit_new($bitveclen);
+my $ff1 = GlueFFI::Bit_new($bitveclen);
+my $ff2 = GlueFFI::Bit_new($bitveclen);
+for my $i ( 0 .. $bitveclen / 2 - 1 ) {
+    Bit_bset( $xs1, $i );
+    Bit_bset( $xs2, $i );
+    GlueFFI::Bit_bset( $ff1, $i );
+    GlueFFI::Bit_bset( $ff2, $i );
+}
+my $xs_out = Bit_new($bitveclen);
+my $ff_out = GlueFFI::Bit_new($bitveclen);
+
+# ns per call of $code run $batch times, minus the cost of the bare loop
+sub time_perl_loop ($code) {
+    my $t0 = clock_gettime(CLOCK_MONOTONIC);
+    $code->();
+    my $t1 = clock_gettime(CLOCK_MONOTONIC);
+    return ( $t1 - $t0 ) * 1e9 / $batch;
+}
+
+# the baseline uses the same statement-modifier loop as every measured call
+# below (a block loop has a different per-iteration cost)
+my $loop_ns = ( sort { $a <=> $b }
+      map { time_perl_loop( sub { 1 for 1 .. $batch } ) } 1 .. 16 )[0];
+
+my @rows;    # [operation, interface, argsize, iteration, ns_per_call]
+my %mean;    # {operation}{argsize}{interface}
+
+sub record ( $op, $iface, $argsize, $iter, $ns ) {
+    push @rows, [ $op, $iface, $argsize, $iter, $ns ];
+    push $mean{$op}{$argsize}{$iface}->@*, $ns;
+}
+
+for my $iter ( 1 .. $iters ) {
+    say "Iteration $iter of $iters";
+
+    # Bit_get
+    record( 'Bit_get', 'C', 1, $iter, $c_kernel{get}->( $bitveclen, $batch ) );
+    record( 'Bit_get', 'XS', 1, $iter,
+        time_perl_loop( sub { Bit_get( $xs1, 2 ) for 1 .. $batch } ) -
+          $loop_ns );
+    record( 'Bit_get', 'FFI', 1, $iter,
+        time_perl_loop( sub { GlueFFI::Bit_get( $ff1, 2 ) for 1 .. $batch } )
+          - $loop_ns );
+
+    # Bit_bset
+    record( 'Bit_bset', 'C', 1, $iter,
+        $c_kernel{bset}->( $bitveclen, $batch ) );
+    record( 'Bit_bset', 'XS', 1, $iter,
+        time_perl_loop( sub { Bit_bset( $xs_out, 3 ) for 1 .. $batch } ) -
+          $loop_ns );
+    record( 'Bit_bset', 'FFI', 1, $iter,
+        time_perl_loop( sub { GlueFFI::Bit_bset( $ff_out, 3 ) for 1 .. $batch }
+        ) - $loop_ns );
+
+    # Bit_aset as a function of the index list length
+    for my $n (@aset_sizes) {
+        my @idx = map { $_ % $bitveclen } 0 .. $n - 1;
+        record( 'Bit_aset', 'C', $n, $iter,
+            $c_kernel{aset}->( $bitveclen, $n, $batch ) );
+        record( 'Bit_aset', 'XS', $n, $iter,
+            time_perl_loop( sub { Bit_aset( $xs_out, \@idx ) for 1 .. $batch } )
+              - $loop_ns );
+        record(
+            'Bit_aset',
+            'FFI', $n, $iter,
+            time_perl_loop(
+                sub { GlueFFI::Bit_aset( $ff_out, \@idx, $n ) for 1 .. $batch }
+            ) - $loop_ns
+        );
+    }
+
+    # Bit_inter_count; argument size is the bit length of both operands
+    record( 'Bit_inter_count', 'C', $bitveclen, $iter,
+        $c_kernel{inter_count}->( $bitveclen, $batch ) );
+    record( 'Bit_inter_count', 'XS', $bitveclen, $iter,
+        time_perl_loop( sub { Bit_inter_count( $xs1, $xs2 ) for 1 .. $batch } )
+          - $loop_ns );
+    record(
+        'Bit_inter_count',
+        'FFI', $bitveclen, $iter,
+        time_perl_loop(
+            sub { GlueFFI::Bit_inter_count( $ff1, $ff2 ) for 1 .. $batch }
+        ) - $loop_ns
+    );
+}
+
+open my $fh, '>', $outfname or die "Error opening file $outfname: $!\n";
+say $fh 'operation,interface,argsize,iteration,ns_per_call';
+say $fh join( ',', $_->@[ 0 .. 3 ], sprintf( '%.3f', $_->[4] ) ) for @rows;
+close $fh;
+
+# summary: mean ns per call and glue overhead relative to direct C
+say sprintf( '%-16s %8s %10s %10s %10s %10s %10s',
+    qw(operation argsize C XS FFI XS-C FFI-C) );
+for my $op ( sort keys %mean ) {
+    for my $n ( sort { $a <=> $b } keys $mean{$op}->%* ) {
+        my %m = map { $_ => sum( $mean{$op}{$n}{$_}->@* ) /
+              scalar( $mean{$op}{$n}{$_}->@* ) } qw(C XS FFI);
+        say sprintf( '%-16s %8d %10.1f %10.1f %10.1f %10.1f %10.1f',
+            $op, $n, @m{qw(C XS FFI)}, $m{XS} - $m{C}, $m{FFI} - $m{C} );
+    }
+}
+
+Bit_free( \$_ ) for ( $xs1, $xs2, $xs_out );
+GlueFFI::Bit_free( \$_ ) for ( $ff1, $ff2, $ff_out );
+
+=pod
+# execute as (after make libgluebench.so)
+perl -e '@bitlen=(128,1024,16384,262144); system("./bench_glue_overhead.pl","-bitlen=$_","-iters=10","-batch=100000") for @bitlen;'
+=cut
@@ -2,34 +2,66 @@
 #include "./c-libs/roaring.c"
 #include "benchmark_helper.h"
 #include <string.h>
+#include <sys/stat.h>
 
 static int *g_rand_indices = NULL;
 static uint32_t *g_rand_indices_u32 = NULL;
 static uint64_t *g_rand_indices_u64 = NULL;
 static int g_rand_indices_len = 0;
+static int *g_clust_indices = NULL;
+static uint32_t *g_clust_indices_u32 = NULL;
+static int g_clust_indices_len = 0;
+static bench_dataset_t g_dataset;  // BENCH_DATASET, if set
+static int g_indices_mapped = 0;   // index arrays point into g_dataset
+static const uint64_t *g_operand[2]; // OPERAND_A/B of g_dataset, if mapped
+
+#define MAX_BENCHMARKS 128
+#define CLUSTER_RUN_LEN 64
+
+typedef double (*benchmark_fn_t)(int, int);
 
 typedef struct benchmark_result {
   char approach[51];
   int number_of_iterations;
   double *time_elapsed;
+  benchmark_fn_t func; // NULL for skipped tests
 } benchmark_result_t;
 
+// Order in which the (benchmark, repetition) pairs are executed; selected
+// through the BENCH_SCHEDULE environment variable.
+typedef enum schedule_kind {
+  SCHEDULE_SEQUENTIAL = 0, // all repetitions of one benchmark, then the next
+  SCHEDULE_SHUFFLE = 1,    // one seeded random permutation of all pairs
+  SCHEDULE_BLOCK = 2       // each round runs every benchmark once, shuffled
+} schedule_kind_t;
+
+typedef struct schedule_entry {
+  int test;      // index into the results array
+  int iteration; // repetition number of that test
+  double start;  // seconds since the schedule started
+  double elapsed;
+} schedule_entry_t;
+
 #define BENCHMARK(library, operation, bitveclen, batch_size, num_iterations,   \
                   results, test_num)                                           \
   do {                                                                         \
-    benchmark_functions(&results[test_num], #library "_" #operation,           \
-                        num_iterations, bitveclen, batch_size,                 \
-                        library##_##operation);                                \
+    schedule_benchmark(&results[test_num], #library "_" #operation,            \
+                       num_iterations, library##_##operation);                 \
     test_num++;                                                                \
   } while (0)
 
-void benchmark_functions(benchmark_result_t *results, char *approach,
-                         int num_results, int bitveclen, int batch_size,
-                         double (*func)(int, int));
+void schedule_benchmark(benchmark_result_t *results, char *approach,
+                        int num_results, benchmark_fn_t func);
+int schedule_kind_from_env(schedule_kind_t *kind);
+void run_schedule(benchmark_result_t *results, int num_results, int bitveclen,
+                  int batch_size, const char *outfile);
 void save_csv(benchmark_result_t *results, int num_results,
               const char *outfile);
+void save_perop_csv(benchmark_result_t *results, int num_results,
+                    int batch_size, const char *outfile);
 void test_bit_funcs(int bitveclen);
 static void init_random_indices(int bitveclen, int length_array);
+static void init_clustered_indices(int bitveclen, int length_array);
 void free_random_indices(void);
 
 // CRoaring benchmark functions
@@ -63,9 +95,91 @@ double Bit_T_PopCount(int bitveclen, int batch_size);
 double Bit_T_Inter(int bitveclen, int batch_size);
 double Bit_T_InterCount(int bitveclen, int batch_size);
 
+// Sorted array benchmark functions
+double SortedArr_new(int bitveclen, int batch_size);
+double SortedArr_FillHalfSeq(int bitveclen, int batch_size);
+double SortedArr_PopCount(int bitveclen, int batch_size);
+double SortedArr_Inter(int bitveclen, int batch_size);
+double SortedArr_InterCount(int bitveclen, int batch_size);
+double SortedArr_InterMerge(int bitveclen, int batch_size);
+double SortedArr_InterCountMerge(int bitveclen, int batch_size);
+double SortedArr_InterCountGallop(int bitveclen, int batch_size);
+
+// Clustered data benchmark functions
+double Bit_T_FillClustered(int bitveclen, int batch_size);
+double Bit_T_FillClusteredMany(int bitveclen, int batch_size);
+double CBitset_FillClustered(int bitveclen, int batch_size);
+double CRoaring_FillClustered(int bitveclen, int batch_size);
+double CRoaring_FillClusteredMany(int bitveclen, int batch_size);
+double CRoaring_FillClusteredRunOpt(int bitveclen, int batch_size);
+double CRoaring_RunOptimize(int bitveclen, int batch_size);
+double Bit_T_PopCountClustered(int bitveclen, int batch_size);
+double CBitset_PopCountClustered(int bitveclen, int batch_size);
+double CRoaring_PopCountClustered(int bitveclen, int batch_size);
+double CRoaring_PopCountClusteredRunOpt(int bitveclen, int batch_size);
+double Bit_T_InterClustered(int bitveclen, int batch_size);
+double CBitset_InterClustered(int bitveclen, int batch_size);
+double CRoaring_InterClustered(int bitveclen, int batch_size);
+double CRoaring_InterClusteredRunOpt(int bitveclen, int batch_size);
+double Bit_T_InterCountClustered(int bitveclen, int batch_size);
+double CBitset_InterCountClustered(int bitveclen, int batch_size);
+double CRoaring_InterCountClustered(int bitveclen, int batch_size);
+double CRoaring_InterCountClusteredRunOpt(int bitveclen, int batch_size);
+
+// Copy and comparison benchmark functions
+double CRoaring_Copy(int bitveclen, int batch_size);
+double CBitset_Copy(int bitveclen, int batch_size);
+double Bit_T_Copy(int bitveclen, int batch_size);
+double CRoaring_EqSame(int bitveclen, int batch_size);
+double CRoaring_EqLateDiff(int bitveclen, int batch_size);
+double CRoaring_EqEarlyDiff(int bitveclen, int batch_size);
+double CRoaring_SubsetSame(int bitveclen, int batch_size);
+double CRoaring_SubsetLateDiff(int bitveclen, int batch_size);
+double CRoaring_SubsetEarlyDiff(int bitveclen, int batch_size);
+double CRoaring_StrictSubsetSame(int bitveclen, int batch_size);
+double CRoaring_StrictSubsetLateDiff(int bitveclen, int batch_size);
+double CRoaring_StrictSubsetEarlyDiff(int bitveclen, int batch_size);
+double CBitset_EqSame(int bitveclen, int batch_size);
+double CBitset_EqLateDiff(int bitveclen, int batch_size);
+double CBitset_EqEarlyDiff(int bitveclen, int batch_size);
+double CBitset_SubsetSame(int bitveclen, int batch_size);
+double CBitset_SubsetLateDiff(int bitveclen, int batch_size);
+double CBitset_SubsetEarlyDiff(int bitveclen, int batch_size);
+double CBitset_StrictSubsetSame(int bitveclen, int batch_size);
+double CBitset_StrictSubsetLateDiff(int bitveclen, int batch_size);
+double CBitset_StrictSubsetEarlyDiff(int bitveclen, int batch_size);
+double Bit_T_EqSame(int bitveclen, int batch_size);
+double Bit_T_EqLateDiff(int bitveclen, int batch_size);
+double Bit_T_EqEarlyDiff(int bitveclen, int batch_size);
+double Bit_T_SubsetSame(int bitveclen, int batch_size);
+double Bit_T_SubsetLateDiff(int bitveclen, int batch_size);
+double Bit_T_SubsetEarlyDiff(int bitveclen, int batch_size);
+double Bit_T_StrictSubsetSame(int bitveclen, int batch_size);
+double Bit_T_StrictSubsetLateDiff(int bitveclen, int batch_size);
+double Bit_T_StrictSubsetEarlyDiff(int bitveclen, int batch_size);
+
+// Crossover search between representations
+int run_crossover(int argc, char *argv[]);
+
+// Huge-page and alignment experiments
+int run_memory(int argc, char *argv[]);
+
+// Shared workload dataset
+int run_dataset(int argc, char *argv[]);
+static int open_dataset(int bitveclen);
+
 static unsigned int g_seed = 100;
 #define MAX_CROARING_MANY 4096
 int main(int argc, char *argv[]) {
+  if (argc >= 2 && strcmp(argv[1], "crossover") == 0) {
+    return run_crossover(argc, argv);
+  }
+  if (argc >= 2 && strcmp(argv[1], "memory") == 0) {
+    return run_memory(argc, argv);
+  }
+  if (argc >= 2 && strcmp(argv[1], "dataset") == 0) {
+    return run_dataset(argc, argv);
+  }
   if (argc != 4 && argc != 6) {
     puts("Usage: ./benchmark <bitveclen> <num of iterations> <batch_size> <maximum size of CRoaring many> [seed]");
     return 1;
@@ -80,6 +194,13 @@ int main(int argc, char *argv[]) {
   assert(bitveclen > 0);
   assert(batch_size > 0);
   assert(num_of_iterations > 0);
+  schedule_kind_t kind;
+  if (schedule_kind_from_env(&kind) != 0) {
+    return 1;
+  }
+  if (open_dataset(bitveclen) != 0) {
+    return 1;
+  }
 
   // Get CPU model
   char cpu[256];
@@ -90,6 +211,14 @@ int main(int argc, char *argv[]) {
   snprintf(outfile, sizeof outfile,
            "results/benchmark_bitvectors_Lang%s_Length%d_Batch%d_CPU%s.csv",
            "C", bitveclen, batch_size, cpu);
+  char schedule_outfile[512];
+  snprintf(schedule_outfile, sizeof schedule_outfile,
+           "results_schedule/benchmark_schedule_Lang%s_Length%d_Batch%d_CPU%s.csv",
+           "C", bitveclen, batch_size, cpu);
+  char perop_outfile[512];
+  snprintf(perop_outfile, sizeof perop_outfile,
+           "results_perop/benchmark_perop_Lang%s_Length%d_Batch%d_CPU%s.csv",
+           "C", bitveclen, batch_size, cpu);
 
   printf("Benchmarking bit vector length %d for %d iterations with batch size "
          "%d on CPU: %s\n",
@@ -99,8 +228,14 @@ int main(int argc, char *argv[]) {
   test_bit_funcs(bitveclen);
   puts("Passed correctness tests.");
 
+  bench_timer_init(batch_size);
+  printf("Timer: %s, TSC %.3f GHz, loop overhead %.1f ns per batch\n",
+         g_timer.kind == BENCH_TIMER_TSC ? "tsc" : "clock",
+         g_timer.tsc_hz / 1.0e9, g_timer.overhead_s * 1.0e9);
+
   init_random_indices(bitveclen, bitveclen / 10);
-  benchmark_result_t results[32];
+  init_clustered_indices(bitveclen, bitveclen / 10);
+  benchmark_result_t results[MAX_BENCHMARKS] = {0};
   int test_num = 0;
 
   // C Roaring benchmarks
@@ -181,7 +316,131 @@ int main(int argc, char *argv[]) {
             test_num);
   BENCHMARK(Bit_T, InterCount, bitveclen, batch_size, num_of_iterations,
             results, test_num);
+
+  // Sorted array benchmarks
+  BENCHMARK(SortedArr, new, bitveclen, batch_size, num_of_iterations, results,
+            test_num);
+  BENCHMARK(SortedArr, FillHalfSeq, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(SortedArr, PopCount, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(SortedArr, Inter, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(SortedArr, InterCount, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(SortedArr, InterMerge, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(SortedArr, InterCountMerge, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(SortedArr, InterCountGallop, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+
+  // Clustered data benchmarks
+  BENCHMARK(CRoaring, FillClustered, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(CRoaring, FillClusteredMany, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, FillClusteredRunOpt, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, RunOptimize, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(CRoaring, PopCountClustered, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, PopCountClusteredRunOpt, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, InterClustered, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, InterClusteredRunOpt, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, InterCountClustered, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, InterCountClusteredRunOpt, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, FillClustered, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(CBitset, PopCountClustered, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, InterClustered, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(CBitset, InterCountClustered, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, FillClustered, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(Bit_T, FillClusteredMany, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, PopCountClustered, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, InterClustered, bitveclen, batch_size, num_of_iterations,
+            results, test_num);
+  BENCHMARK(Bit_T, InterCountClustered, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+
+  // Copy and comparison benchmarks
+  BENCHMARK(CRoaring, Copy, bitveclen, batch_size, num_of_iterations, results,
+            test_num);
+  BENCHMARK(CRoaring, EqSame, bitveclen, batch_size, num_of_iterations, results,
+            test_num);
+  BENCHMARK(CRoaring, EqLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, EqEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, SubsetSame, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, SubsetLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, SubsetEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, StrictSubsetSame, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, StrictSubsetLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CRoaring, StrictSubsetEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, Copy, bitveclen, batch_size, num_of_iterations, results,
+            test_num);
+  BENCHMARK(CBitset, EqSame, bitveclen, batch_size, num_of_iterations, results,
+            test_num);
+  BENCHMARK(CBitset, EqLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, EqEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, SubsetSame, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, SubsetLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, SubsetEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, StrictSubsetSame, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, StrictSubsetLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(CBitset, StrictSubsetEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, Copy, bitveclen, batch_size, num_of_iterations, results,
+            test_num);
+  BENCHMARK(Bit_T, EqSame, bitveclen, batch_size, num_of_iterations, results,
+            test_num);
+  BENCHMARK(Bit_T, EqLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, EqEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, SubsetSame, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, SubsetLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, SubsetEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, StrictSubsetSame, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, StrictSubsetLateDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  BENCHMARK(Bit_T, StrictSubsetEarlyDiff, bitveclen, batch_size,
+            num_of_iterations, results, test_num);
+  mkdir("results_schedule", 0755);
+  run_schedule(results, test_num, bitveclen, batch_size, schedule_outfile);
   save_csv(results, test_num, outfile);
+  mkdir("results_perop", 0755);
+  save_perop_csv(results, test_num, batch_size, perop_outfile);
   free_random_indices();
 }
 
@@ -193,40 +452,40 @@ int main(int argc, char *argv[]) {
 
 double CRoaring_new(int bitveclen, int batch_size) {
   roaring_bitmap_t *r1;
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     r1 = roaring_bitmap_create_with_capacity(bitveclen);
     assert(r1 != NULL);
     roaring_bitmap_free(r1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double CRoaring_FillHalfSeq(int bitveclen, int batch_size) {
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int b = 0; b < batch_size; b++) {
     roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
     assert(r1 != NULL);
-    for (int i = 0; i < bitveclen / 2; i++) {
+    for (int i = 0; i < g_rand_indices_len; i++) {
       roaring_bitmap_add(r1, g_rand_indices_u32[i]);
     }
     roaring_bitmap_free(r1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double CRoaring_FillHalfMany(int bitveclen, int batch_size) {
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int b = 0; b < batch_size; b++) {
     roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
     assert(r1 != NULL);
@@ -235,8 +494,8 @@ double CRoaring_FillHalfMany(int bitveclen, int batch_size) {
     }
     roaring_bitmap_free(r1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
@@ -248,15 +507,16 @@ double CRoaring_PopCount(int bitveclen, int batch_size) {
     roaring_bitmap_add(r1, (uint32_t)g_rand_indices[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile uint64_t count = roaring_bitmap_get_cardinality(r1);
-    (void)count;
+    BENCH_ESCAPE(r1);
+    uint64_t count = roaring_bitmap_get_cardinality(r1);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   roaring_bitmap_free(r1);
   return timeElapsed;
 }
@@ -272,16 +532,16 @@ double CRoaring_Inter(int bitveclen, int batch_size) {
     roaring_bitmap_add(r2, (uint32_t)g_rand_indices[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     roaring_bitmap_t *r_and = roaring_bitmap_and(r1, r2);
     assert(r_and != NULL);
     roaring_bitmap_free(r_and);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
   roaring_bitmap_free(r1);
   roaring_bitmap_free(r2);
@@ -299,15 +559,17 @@ double CRoaring_InterCount(int bitveclen, int batch_size) {
     roaring_bitmap_add(r2, (uint32_t)g_rand_indices[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile uint64_t count = roaring_bitmap_and_cardinality(r1, r2);
-    (void)count;
+    BENCH_ESCAPE(r1);
+    BENCH_ESCAPE(r2);
+    uint64_t count = roaring_bitmap_and_cardinality(r1, r2);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
   roaring_bitmap_free(r1);
   roaring_bitmap_free(r2);
@@ -320,40 +582,40 @@ double CRoaring_InterCount(int bitveclen, int batch_size) {
 ******************************************************************************/
 double CRoaring64_new(int bitveclen, int batch_size) {
   roaring64_bitmap_t *r1;
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     r1 = roaring64_bitmap_create();
     assert(r1 != NULL);
     roaring64_bitmap_free(r1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double CRoaring64_FillHalfSeq(int bitveclen, int batch_size) {
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int b = 0; b < batch_size; b++) {
     roaring64_bitmap_t *r1 = roaring64_bitmap_create();
     assert(r1 != NULL);
-    for (int i = 0; i < bitveclen / 2; i++) {
+    for (int i = 0; i < g_rand_indices_len; i++) {
       roaring64_bitmap_add(r1, g_rand_indices_u64[i]);
     }
     roaring64_bitmap_free(r1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double CRoaring64_FillHalfMany(int bitveclen, int batch_size) {
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int b = 0; b < batch_size; b++) {
     roaring64_bitmap_t *r1 = roaring64_bitmap_create();
     assert(r1 != NULL);
@@ -362,8 +624,8 @@ double CRoaring64_FillHalfMany(int bitveclen, int batch_size) {
     }
     roaring64_bitmap_free(r1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
@@ -375,15 +637,16 @@ double CRoaring64_PopCount(int bitveclen, int batch_size) {
     roaring64_bitmap_add(r1, g_rand_indices_u64[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile uint64_t count = roaring64_bitmap_get_cardinality(r1);
-    (void)count;
+    BENCH_ESCAPE(r1);
+    uint64_t count = roaring64_bitmap_get_cardinality(r1);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   roaring64_bitmap_free(r1);
   return timeElapsed;
 }
@@ -399,16 +662,16 @@ double CRoaring64_Inter(int bitveclen, int batch_size) {
     roaring64_bitmap_add(r2, g_rand_indices_u64[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     roaring64_bitmap_t *r_and = roaring64_bitmap_and(r1, r2);
     assert(r_and != NULL);
     roaring64_bitmap_free(r_and);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
   roaring64_bitmap_free(r1);
   roaring64_bitmap_free(r2);
@@ -426,15 +689,17 @@ double CRoaring64_InterCount(int bitveclen, int batch_size) {
     roaring64_bitmap_add(r2, g_rand_indices_u64[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile uint64_t count = roaring64_bitmap_and_cardinality(r1, r2);
-    (void)count;
+    BENCH_ESCAPE(r1);
+    BENCH_ESCAPE(r2);
+    uint64_t count = roaring64_bitmap_and_cardinality(r1, r2);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
   roaring64_bitmap_free(r1);
   roaring64_bitmap_free(r2);
@@ -447,25 +712,38 @@ double CRoaring64_InterCount(int bitveclen, int batch_size) {
 
 ******************************************************************************/
 
+// With a dataset, the operands of PopCount/Inter/InterCount are read-only
+// views of its OPERAND_A/OPERAND_B bitmaps: bitset_t is a public struct that
+// can point at them. Otherwise a new set is returned for the caller to fill.
+// Views are never passed to bitset_free.
+static bitset_t *cbitset_operand(bitset_t *view, int k, int bitveclen) {
+  if (!g_operand[k])
+    return bitset_create_with_capacity(bitveclen);
+  view->array = (uint64_t *)g_operand[k];
+  view->arraysize = ((size_t)bitveclen + 63) / 64;
+  view->capacity = view->arraysize;
+  return view;
+}
+
 double CBitset_new(int bitveclen, int batch_size) {
   bitset_t *b1;
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     b1 = bitset_create_with_capacity(bitveclen);
     assert(b1 != NULL);
     bitset_free(b1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double CBitset_FillHalfSeq(int bitveclen, int batch_size) {
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int b = 0; b < batch_size; b++) {
     bitset_t *b1 = bitset_create_with_capacity(bitveclen);
     assert(b1 != NULL);
@@ -474,85 +752,96 @@ double CBitset_FillHalfSeq(int bitveclen, int batch_size) {
     }
     bitset_free(b1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double CBitset_PopCount(int bitveclen, int batch_size) {
-  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+  bitset_t view;
+  bitset_t *b1 = cbitset_operand(&view, 0, bitveclen);
   assert(b1 != NULL);
   // set random bits (up to bitveclen/2 draws); do not check for duplicates
   srand(g_seed);
-  for (int i = 0; i < g_rand_indices_len; i++) {
+  for (int i = 0; b1 != &view && i < g_rand_indices_len; i++) {
     int idx = g_rand_indices[i];
     bitset_set(b1, (size_t)idx);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile uint64_t count = bitset_count(b1);
-    (void)count;
+    BENCH_ESCAPE(b1);
+    uint64_t count = bitset_count(b1);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
-  bitset_free(b1);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  if (b1 != &view)
+    bitset_free(b1);
   return timeElapsed;
 }
 
 double CBitset_Inter(int bitveclen, int batch_size) {
-  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
-  bitset_t *b2 = bitset_create_with_capacity(bitveclen);
+  bitset_t view[2];
+  bitset_t *b1 = cbitset_operand(&view[0], 0, bitveclen);
+  bitset_t *b2 = cbitset_operand(&view[1], 1, bitveclen);
   assert(b1 != NULL && b2 != NULL);
 
   // set half the bits in both bitsets (deterministic, reproducible)
-  for (int i = 0; i < bitveclen / 2; i++) {
+  for (int i = 0; b1 != &view[0] && i < bitveclen / 2; i++) {
     bitset_set(b1, (size_t)i);
     bitset_set(b2, (size_t)i);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     bitset_t *tmp = bitset_copy(b1);
     assert(tmp != NULL);
     bitset_inplace_intersection(tmp, b2);
     bitset_free(tmp);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
-  bitset_free(b1);
-  bitset_free(b2);
+  if (b1 != &view[0]) {
+    bitset_free(b1);
+    bitset_free(b2);
+  }
   return timeElapsed;
 }
 
 double CBitset_InterCount(int bitveclen, int batch_size) {
-  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
-  bitset_t *b2 = bitset_create_with_capacity(bitveclen);
+  bitset_t view[2];
+  bitset_t *b1 = cbitset_operand(&view[0], 0, bitveclen);
+  bitset_t *b2 = cbitset_operand(&view[1], 1, bitveclen);
   assert(b1 != NULL && b2 != NULL);
 
   // set half the bits in both bitsets (deterministic, reproducible)
-  for (int i = 0; i < g_rand_indices_len; i++) {
+  for (int i = 0; b1 != &view[0] && i < g_rand_indices_len; i++) {
     bitset_set(b1, (size_t)g_rand_indices[i]);
     bitset_set(b2, (size_t)g_rand_indices[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile size_t count = bitset_intersection_count(b1, b2);
-    (void)count;
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    size_t count = bitset_intersection_count(b1, b2);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
-  bitset_free(b1);
-  bitset_free(b2);
+  if (b1 != &view[0]) {
+    bitset_free(b1);
+    bitset_free(b2);
+  }
   return timeElapsed;
 }
 
@@ -562,25 +851,33 @@ double CBitset_InterCount(int bitveclen, int batch_size) {
 
 ******************************************************************************/
 
+// Bit_T counterpart of cbitset_operand: Bit_load wraps the dataset bitmap in
+// place (Bit_free leaves the mapping alone); otherwise a new set to fill.
+static Bit_T bit_t_operand(int k, int bitveclen) {
+  if (!g_operand[k])
+    return Bit_new(bitveclen);
+  return Bit_load(bitveclen, (void *)g_operand[k]);
+}
+
 double Bit_T_new(int bitveclen, int batch_size) {
   Bit_T b1;
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     b1 = Bit_new(bitveclen);
     assert(b1 != NULL);
     Bit_free(&b1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double Bit_T_FillHalfSeq(int bitveclen, int batch_size) {
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int b = 0; b < batch_size; b++) {
     Bit_T b1 = Bit_new(bitveclen);
     assert(b1 != NULL);
@@ -589,70 +886,71 @@ double Bit_T_FillHalfSeq(int bitveclen, int batch_size) {
     }
     Bit_free(&b1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double Bit_T_FillHalfMany(int bitveclen, int batch_size) {
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int b = 0; b < batch_size; b++) {
     Bit_T b1 = Bit_new(bitveclen);
     assert(b1 != NULL);
     Bit_aset(b1, g_rand_indices, g_rand_indices_len);
     Bit_free(&b1);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   return timeElapsed;
 }
 
 double Bit_T_PopCount(int bitveclen, int batch_size) {
-  Bit_T b1 = Bit_new(bitveclen);
+  Bit_T b1 = bit_t_operand(0, bitveclen);
   assert(b1 != NULL);
   // set random bits (up to bitveclen/2 draws); do not check for duplicates
   srand(g_seed);
-  for (int i = 0; i < g_rand_indices_len; i++) {
+  for (int i = 0; !g_operand[0] && i < g_rand_indices_len; i++) {
     int idx = g_rand_indices[i];
     Bit_bset(b1, idx);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile uint64_t count = Bit_count(b1);
-    (void)count;
+    BENCH_ESCAPE(b1);
+    uint64_t count = Bit_count(b1);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
   Bit_free(&b1);
   return timeElapsed;
 }
 
 double Bit_T_Inter(int bitveclen, int batch_size) {
-  Bit_T b1 = Bit_new(bitveclen);
-  Bit_T b2 = Bit_new(bitveclen);
+  Bit_T b1 = bit_t_operand(0, bitveclen);
+  Bit_T b2 = bit_t_operand(1, bitveclen);
   assert(b1 != NULL && b2 != NULL);
 
   // set half the bits in both bitsets (deterministic, reproducible)
-  for (int i = 0; i < bitveclen / 2; i++) {
+  for (int i = 0; !g_operand[0] && i < bitveclen / 2; i++) {
     Bit_bset(b1, i);
     Bit_bset(b2, i);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
     Bit_T inter = Bit_inter(b1, b2);
     assert(inter != NULL);
     Bit_free(&inter);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
   Bit_free(&b1);
   Bit_free(&b2);
@@ -660,155 +958,2368 @@ double Bit_T_Inter(int bitveclen, int batch_size) {
 }
 
 double Bit_T_InterCount(int bitveclen, int batch_size) {
-  Bit_T b1 = Bit_new(bitveclen);
-  Bit_T b2 = Bit_new(bitveclen);
+  Bit_T b1 = bit_t_operand(0, bitveclen);
+  Bit_T b2 = bit_t_operand(1, bitveclen);
   assert(b1 != NULL && b2 != NULL);
 
   // set half the bits in both bitsets (deterministic, reproducible)
-  for (int i = 0; i < g_rand_indices_len; i++) {
+  for (int i = 0; !g_operand[0] && i < g_rand_indices_len; i++) {
     Bit_bset(b1, g_rand_indices[i]);
     Bit_bset(b2, g_rand_indices[i]);
   }
 
-  struct timespec start_time, end_time;
+  bench_stamp_t start_time, end_time;
   double timeElapsed = 0;
-  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  bench_timer_start(&start_time);
   for (int i = 0; i < batch_size; i++) {
-    volatile int count = Bit_inter_count(b1, b2);
-    (void)count;
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    int count = Bit_inter_count(b1, b2);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  clock_gettime(CLOCK_MONOTONIC, &end_time);
-  timeElapsed = timeDiff(&end_time, &start_time);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
   Bit_free(&b1);
   Bit_free(&b2);
   return timeElapsed;
 }
 
-/*****************************************************************************/
+/******************************************************************************
 
-// create a CRoaring, a Cbitset and a Bit_T, set half the bits, and count the
-// number of set bits
-void test_bit_funcs(int bitveclen) {
-  // CRoaring
-  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
-  roaring_bitmap_t *r2 = roaring_bitmap_create_with_capacity(bitveclen);
-  int *arr = (int *)calloc((bitveclen / 2), sizeof(int));
-  assert(r1 != NULL);
-  for (int i = 0; i < bitveclen / 2; i++) {
-    roaring_bitmap_add(r1, i);
-    arr[i] = i;
+* Sorted array
+
+******************************************************************************/
+
+// The set as a strictly increasing array of uint32 ids, the usual alternative
+// to a bitmap for sparse data. Besides the ids, the fill keeps their low 16
+// bits grouped by high 16 bits so that intersections can run CRoaring's
+// array-container kernels chunk by chunk: intersect_vector16 (SSE4.2, used
+// when CRoaring reports AVX2 just as array_container_intersection does) or
+// the scalar intersect_uint16 elsewhere. The *Merge variants run CRoaring's
+// scalar intersection_uint32 over the full ids, and InterCountGallop
+// intersects a 1/64 sample against the full array by galloping search.
+
+typedef struct sorted_ids {
+  uint32_t *ids;  // strictly increasing
+  uint16_t *low;  // low 16 bits of ids
+  uint16_t *keys; // distinct high 16 bits of ids, increasing
+  int *key_start; // ids with high bits keys[k] are [key_start[k], key_start[k+1])
+  int n;
+  int nkeys;
+  int capacity;
+} sorted_ids_t;
+
+#define SORTED_GALLOP_STRIDE 64
+// intersect_vector16 stores whole 16-byte vectors past the last match
+#define SORTED_SIMD_PAD 8
+
+static sorted_ids_t *sorted_ids_new(int capacity) {
+  sorted_ids_t *s = (sorted_ids_t *)malloc(sizeof *s);
+  if (!s)
+    return NULL;
+  size_t cap = (size_t)capacity + 1;
+  s->ids = (uint32_t *)malloc(cap * sizeof(uint32_t));
+  s->low = (uint16_t *)malloc(cap * sizeof(uint16_t));
+  s->keys = (uint16_t *)malloc(cap * sizeof(uint16_t));
+  s->key_start = (int *)malloc((cap + 1) * sizeof(int));
+  s->n = 0;
+  s->nkeys = 0;
+  s->capacity = capacity;
+  if (!s->ids || !s->low || !s->keys || !s->key_start) {
+    free(s->ids);
+    free(s->low);
+    free(s->keys);
+    free(s->key_start);
+    free(s);
+    return NULL;
   }
-  uint64_t count1 = roaring_bitmap_get_cardinality(r1);
-  roaring_bitmap_add_many(r2, bitveclen / 2, (uint32_t *)arr);
-  uint64_t countr2 = roaring_bitmap_get_cardinality(r2);
-  free(arr);
-  roaring_bitmap_free(r1);
-  roaring_bitmap_free(r2);
-  // CBitset
-  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
-  assert(b1 != NULL);
-  for (int i = 0; i < bitveclen / 2; i++) {
-    bitset_set(b1, i);
+  return s;
+}
+
+static void sorted_ids_free(sorted_ids_t *s) {
+  if (!s)
+    return;
+  free(s->ids);
+  free(s->low);
+  free(s->keys);
+  free(s->key_start);
+  free(s);
+}
+
+static int cmp_u32(const void *x, const void *y) {
+  uint32_t a = *(const uint32_t *)x, b = *(const uint32_t *)y;
+  return (a > b) - (a < b);
+}
+
+// Replaces the contents with the distinct values of idx[0..len).
+static void sorted_ids_fill(sorted_ids_t *s, const uint32_t *idx, int len) {
+  assert(len <= s->capacity);
+  if (len > 0)
+    memcpy(s->ids, idx, (size_t)len * sizeof(uint32_t));
+  qsort(s->ids, (size_t)len, sizeof(uint32_t), cmp_u32);
+  int n = 0;
+  for (int i = 0; i < len; i++) {
+    if (n == 0 || s->ids[n - 1] != s->ids[i])
+      s->ids[n++] = s->ids[i];
   }
-  uint64_t count2 = bitset_count(b1);
-  bitset_free(b1);
+  s->n = n;
+  s->nkeys = 0;
+  for (int i = 0; i < n; i++) {
+    uint16_t key = (uint16_t)(s->ids[i] >> 16);
+    if (s->nkeys == 0 || s->keys[s->nkeys - 1] != key) {
+      s->keys[s->nkeys] = key;
+      s->key_start[s->nkeys++] = i;
+    }
+    s->low[i] = (uint16_t)(s->ids[i] & 0xFFFF);
+  }
+  s->key_start[s->nkeys] = n;
+}
 
-  // Bit_T
-  Bit_T b2 = Bit_new(bitveclen);
-  assert(b2 != NULL);
-  for (int i = 0; i < bitveclen / 2; i++) {
-    Bit_bset(b2, i);
+// Cardinality by a checked scan: counts the ids that keep the array strictly
+// increasing, so every id is read, as a bitmap popcount reads every word.
+static int sorted_ids_count(const sorted_ids_t *s) {
+  int count = s->n > 0;
+  for (int i = 1; i < s->n; i++)
+    count += s->ids[i] > s->ids[i - 1];
+  return count;
+}
+
+static int32_t sorted_chunk_inter(const uint16_t *a, size_t na,
+                                  const uint16_t *b, size_t nb, uint16_t *out) {
+#if CROARING_IS_X64
+  if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2)
+    return intersect_vector16(a, na, b, nb, out);
+#endif
+  return intersect_uint16(a, na, b, nb, out);
+}
+
+static int32_t sorted_chunk_card(const uint16_t *a, size_t na,
+                                 const uint16_t *b, size_t nb) {
+#if CROARING_IS_X64
+  if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2)
+    return intersect_vector16_cardinality(a, na, b, nb);
+#endif
+  return intersect_uint16_cardinality(a, na, b, nb);
+}
+
+// Writes a AND b to out (room for min(a->n, b->n) ids); scratch needs room for
+// min(a->n, b->n) + SORTED_SIMD_PAD values. Returns the number of ids.
+static int sorted_ids_inter(const sorted_ids_t *a, const sorted_ids_t *b,
+                            uint32_t *out, uint16_t *scratch) {
+  int i = 0, j = 0, n = 0;
+  while (i < a->nkeys && j < b->nkeys) {
+    if (a->keys[i] < b->keys[j]) {
+      i++;
+    } else if (a->keys[i] > b->keys[j]) {
+      j++;
+    } else {
+      uint32_t high = (uint32_t)a->keys[i] << 16;
+      int32_t c = sorted_chunk_inter(
+          a->low + a->key_start[i],
+          (size_t)(a->key_start[i + 1] - a->key_start[i]),
+          b->low + b->key_start[j],
+          (size_t)(b->key_start[j + 1] - b->key_start[j]), scratch);
+      for (int32_t k = 0; k < c; k++) {
+        out[n++] = high | scratch[k];
+      }
+      i++;
+      j++;
+    }
   }
-  uint64_t count3 = Bit_count(b2);
-  Bit_free(&b2);
+  return n;
+}
 
-  // Verify counts are equal
-  assert(count1 == count2 && count2 == count3 && count3 == countr2);
+static size_t sorted_ids_inter_count(const sorted_ids_t *a,
+                                     const sorted_ids_t *b) {
+  int i = 0, j = 0;
+  size_t count = 0;
+  while (i < a->nkeys && j < b->nkeys) {
+    if (a->keys[i] < b->keys[j]) {
+      i++;
+    } else if (a->keys[i] > b->keys[j]) {
+      j++;
+    } else {
+      count += (size_t)sorted_chunk_card(
+          a->low + a->key_start[i],
+          (size_t)(a->key_start[i + 1] - a->key_start[i]),
+          b->low + b->key_start[j],
+          (size_t)(b->key_start[j + 1] - b->key_start[j]));
+      i++;
+      j++;
+    }
+  }
+  return count;
 }
-// Benchmarking helper functions
-void benchmark_functions(benchmark_result_t *results, char *approach,
-                         int num_results, int bitveclen, int batch_size,
-                         double (*func)(int, int)) {
 
-  strncpy(results->approach, approach, sizeof(results->approach) - 1);
+// |small AND large| by exponential then binary search of large for every
+// element of small; O(ns log(nl / ns)), the right kernel for skewed sizes.
+static size_t sorted_gallop_card(const uint32_t *small, size_t ns,
+                                 const uint32_t *large, size_t nl) {
+  size_t count = 0, lo = 0;
+  for (size_t i = 0; i < ns && lo < nl; i++) {
+    uint32_t v = small[i];
+    size_t hi = lo, step = 1;
+    while (hi < nl && large[hi] < v) {
+      lo = hi + 1;
+      hi += step;
+      step <<= 1;
+    }
+    if (hi > nl)
+      hi = nl;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (large[mid] < v)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo < nl && large[lo] == v) {
+      count++;
+      lo++;
+    }
+  }
+  return count;
+}
 
-  results->number_of_iterations = num_results;
-  results->time_elapsed = (double *)malloc(num_results * sizeof(double));
+// Both operands hold the uniform indices, as for the bitmap libraries.
+static void sorted_operands(sorted_ids_t **a, sorted_ids_t **b) {
+  *a = sorted_ids_new(g_rand_indices_len);
+  *b = sorted_ids_new(g_rand_indices_len);
+  assert(*a != NULL && *b != NULL);
+  sorted_ids_fill(*a, g_rand_indices_u32, g_rand_indices_len);
+  sorted_ids_fill(*b, g_rand_indices_u32, g_rand_indices_len);
+}
 
-  for (int i = 0; i < num_results; i++) {
-    results->time_elapsed[i] = func(bitveclen, batch_size);
+double SortedArr_new(int bitveclen, int batch_size) {
+  sorted_ids_t *s1;
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    s1 = sorted_ids_new(g_rand_indices_len);
+    assert(s1 != NULL);
+    sorted_ids_free(s1);
   }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
 }
 
-void save_csv(benchmark_result_t *results, int num_results,
-              const char *outfile) {
-  FILE *f = fopen(outfile, "w");
-  if (!f) {
-    fprintf(stderr, "Error opening file %s for writing\n", outfile);
-    return;
+// sort + dedup of the unordered indices, the array analogue of setting them
+// one at a time
+double SortedArr_FillHalfSeq(int bitveclen, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int b = 0; b < batch_size; b++) {
+    sorted_ids_t *s1 = sorted_ids_new(g_rand_indices_len);
+    assert(s1 != NULL);
+    sorted_ids_fill(s1, g_rand_indices_u32, g_rand_indices_len);
+    sorted_ids_free(s1);
   }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
 
-  // Write header i.e. the approach strings
-  for (int i = 0; i < num_results - 1; i++) {
-    fprintf(f, "%s,", results[i].approach);
+double SortedArr_PopCount(int bitveclen, int batch_size) {
+  sorted_ids_t *s1 = sorted_ids_new(g_rand_indices_len);
+  assert(s1 != NULL);
+  sorted_ids_fill(s1, g_rand_indices_u32, g_rand_indices_len);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(s1);
+    int count = sorted_ids_count(s1);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
-  fprintf(f, "%s\n", results[num_results - 1].approach);
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  sorted_ids_free(s1);
+  return timeElapsed;
+}
 
-  // Write data
-  for (int j = 1; j <= results[0].number_of_iterations; j++) {
-    for (int i = 0; i < num_results - 1; i++) {
-      fprintf(f, "%lf,", results[i].time_elapsed[j - 1]);
-    }
-    fprintf(f, "%lf\n", results[num_results - 1].time_elapsed[j - 1]);
+double SortedArr_Inter(int bitveclen, int batch_size) {
+  sorted_ids_t *s1, *s2;
+  sorted_operands(&s1, &s2);
+  uint16_t *scratch = (uint16_t *)malloc(
+      ((size_t)s1->n + SORTED_SIMD_PAD) * sizeof(uint16_t));
+  assert(scratch != NULL);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(s1);
+    BENCH_ESCAPE(s2);
+    uint32_t *out = (uint32_t *)malloc(((size_t)s1->n + 1) * sizeof(uint32_t));
+    assert(out != NULL);
+    int n = sorted_ids_inter(s1, s2, out, scratch);
+    BENCH_DO_NOT_OPTIMIZE(n);
+    free(out);
   }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
-  fclose(f);
+  free(scratch);
+  sorted_ids_free(s1);
+  sorted_ids_free(s2);
+  return timeElapsed;
 }
 
-// Returns a pointer to a static array of length == bitveclen.
-// Each entry is a random integer in [0, bitveclen-1], generated
-// reproducibly from g_seed.
-static void init_random_indices(int bitveclen, int length_array) {
-  if (bitveclen <= 0 || length_array <= 0) {
-    return;
+double SortedArr_InterCount(int bitveclen, int batch_size) {
+  sorted_ids_t *s1, *s2;
+  sorted_operands(&s1, &s2);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(s1);
+    BENCH_ESCAPE(s2);
+    size_t count = sorted_ids_inter_count(s1, s2);
+    BENCH_DO_NOT_OPTIMIZE(count);
   }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
 
-  if (g_rand_indices == NULL || g_rand_indices_len != length_array) {
-    unsigned int *tmp =
-        (int *)calloc((size_t)length_array, sizeof(unsigned int));
-    uint32_t *tmp_u32 =
-        (uint32_t *)calloc((size_t)length_array, sizeof(uint32_t));
-    uint64_t *tmp_u64 =
-        (uint64_t *)calloc((size_t)length_array, sizeof(uint64_t));
-    if (!tmp || !tmp_u32 || !tmp_u64) {
-      free(g_rand_indices);
-      free(g_rand_indices_u32);
-      free(g_rand_indices_u64);
-      g_rand_indices = NULL;
-      g_rand_indices_len = 0;
-      return;
+  sorted_ids_free(s1);
+  sorted_ids_free(s2);
+  return timeElapsed;
+}
+
+double SortedArr_InterMerge(int bitveclen, int batch_size) {
+  sorted_ids_t *s1, *s2;
+  sorted_operands(&s1, &s2);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(s1);
+    BENCH_ESCAPE(s2);
+    uint32_t *out = (uint32_t *)malloc(((size_t)s1->n + 1) * sizeof(uint32_t));
+    assert(out != NULL);
+    size_t n = intersection_uint32(s1->ids, (size_t)s1->n, s2->ids,
+                                   (size_t)s2->n, out);
+    BENCH_DO_NOT_OPTIMIZE(n);
+    free(out);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  sorted_ids_free(s1);
+  sorted_ids_free(s2);
+  return timeElapsed;
+}
+
+double SortedArr_InterCountMerge(int bitveclen, int batch_size) {
+  sorted_ids_t *s1, *s2;
+  sorted_operands(&s1, &s2);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(s1);
+    BENCH_ESCAPE(s2);
+    size_t count = intersection_uint32_card(s1->ids, (size_t)s1->n, s2->ids,
+                                            (size_t)s2->n);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  sorted_ids_free(s1);
+  sorted_ids_free(s2);
+  return timeElapsed;
+}
+
+// every SORTED_GALLOP_STRIDE-th id against the full array
+double SortedArr_InterCountGallop(int bitveclen, int batch_size) {
+  sorted_ids_t *s1, *s2;
+  sorted_operands(&s1, &s2);
+  int ns = 0;
+  for (int i = 0; i < s1->n; i += SORTED_GALLOP_STRIDE) {
+    s1->ids[ns++] = s1->ids[i];
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(s1);
+    BENCH_ESCAPE(s2);
+    size_t count =
+        sorted_gallop_card(s1->ids, (size_t)ns, s2->ids, (size_t)s2->n);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  sorted_ids_free(s1);
+  sorted_ids_free(s2);
+  return timeElapsed;
+}
+
+/******************************************************************************
+
+* Clustered data (all libraries)
+
+******************************************************************************/
+
+// Same number of set bits as the uniform benchmarks, but drawn as runs of up
+// to CLUSTER_RUN_LEN consecutive positions (time ranges, sorted ID blocks).
+// CRoaring is measured as built and after roaring_bitmap_run_optimize; the
+// cost of the optimize call itself is CRoaring_RunOptimize.
+
+double Bit_T_FillClustered(int bitveclen, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int b = 0; b < batch_size; b++) {
+    Bit_T b1 = Bit_new(bitveclen);
+    assert(b1 != NULL);
+    for (int i = 0; i < g_clust_indices_len; i++) {
+      Bit_bset(b1, g_clust_indices[i]);
     }
-    g_rand_indices = tmp;
-    g_rand_indices_u32 = tmp_u32;
-    g_rand_indices_u64 = tmp_u64;
-    g_rand_indices_len = length_array;
+    Bit_free(&b1);
   }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
 
-  srand(g_seed);
-  for (int i = 0; i < length_array; i++) {
-    g_rand_indices[i] = rand() % (bitveclen / 2);
-    g_rand_indices_u32[i] = (uint32_t)g_rand_indices[i];
-    g_rand_indices_u64[i] = (uint64_t)g_rand_indices[i];
+double Bit_T_FillClusteredMany(int bitveclen, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int b = 0; b < batch_size; b++) {
+    Bit_T b1 = Bit_new(bitveclen);
+    assert(b1 != NULL);
+    Bit_aset(b1, g_clust_indices, g_clust_indices_len);
+    Bit_free(&b1);
   }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
 }
 
-void free_random_indices(void) {
-  free(g_rand_indices);
+double CBitset_FillClustered(int bitveclen, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int b = 0; b < batch_size; b++) {
+    bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+    assert(b1 != NULL);
+    for (int i = 0; i < g_clust_indices_len; i++) {
+      bitset_set(b1, (size_t)g_clust_indices[i]);
+    }
+    bitset_free(b1);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
+
+double CRoaring_FillClustered(int bitveclen, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int b = 0; b < batch_size; b++) {
+    roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+    assert(r1 != NULL);
+    for (int i = 0; i < g_clust_indices_len; i++) {
+      roaring_bitmap_add(r1, g_clust_indices_u32[i]);
+    }
+    roaring_bitmap_free(r1);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
+
+double CRoaring_FillClusteredMany(int bitveclen, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int b = 0; b < batch_size; b++) {
+    roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+    assert(r1 != NULL);
+    roaring_bitmap_add_many(r1, g_clust_indices_len, g_clust_indices_u32);
+    roaring_bitmap_free(r1);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
+
+// fill followed by run_optimize, i.e. the full cost of building a run bitmap
+double CRoaring_FillClusteredRunOpt(int bitveclen, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int b = 0; b < batch_size; b++) {
+    roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+    assert(r1 != NULL);
+    roaring_bitmap_add_many(r1, g_clust_indices_len, g_clust_indices_u32);
+    roaring_bitmap_run_optimize(r1);
+    roaring_bitmap_free(r1);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
+
+// run_optimize alone: the batch of unoptimized copies is built untimed
+double CRoaring_RunOptimize(int bitveclen, int batch_size) {
+  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+  roaring_bitmap_t **copies =
+      (roaring_bitmap_t **)malloc(sizeof(roaring_bitmap_t *) * batch_size);
+  assert(r1 != NULL && copies != NULL);
+  roaring_bitmap_add_many(r1, g_clust_indices_len, g_clust_indices_u32);
+  for (int i = 0; i < batch_size; i++) {
+    copies[i] = roaring_bitmap_copy(r1);
+    assert(copies[i] != NULL);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    bool changed = roaring_bitmap_run_optimize(copies[i]);
+    BENCH_DO_NOT_OPTIMIZE(changed);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  for (int i = 0; i < batch_size; i++) {
+    roaring_bitmap_free(copies[i]);
+  }
+  free(copies);
+  roaring_bitmap_free(r1);
+  return timeElapsed;
+}
+
+double Bit_T_PopCountClustered(int bitveclen, int batch_size) {
+  Bit_T b1 = Bit_new(bitveclen);
+  assert(b1 != NULL);
+  Bit_aset(b1, g_clust_indices, g_clust_indices_len);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    int count = Bit_count(b1);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  Bit_free(&b1);
+  return timeElapsed;
+}
+
+double CBitset_PopCountClustered(int bitveclen, int batch_size) {
+  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+  assert(b1 != NULL);
+  for (int i = 0; i < g_clust_indices_len; i++) {
+    bitset_set(b1, (size_t)g_clust_indices[i]);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    size_t count = bitset_count(b1);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  bitset_free(b1);
+  return timeElapsed;
+}
+
+static double croaring_popcount_clustered(int bitveclen, int batch_size,
+                                          int run_optimize) {
+  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+  assert(r1 != NULL);
+  roaring_bitmap_add_many(r1, g_clust_indices_len, g_clust_indices_u32);
+  if (run_optimize)
+    roaring_bitmap_run_optimize(r1);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(r1);
+    uint64_t count = roaring_bitmap_get_cardinality(r1);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  roaring_bitmap_free(r1);
+  return timeElapsed;
+}
+
+double CRoaring_PopCountClustered(int bitveclen, int batch_size) {
+  return croaring_popcount_clustered(bitveclen, batch_size, 0);
+}
+
+double CRoaring_PopCountClusteredRunOpt(int bitveclen, int batch_size) {
+  return croaring_popcount_clustered(bitveclen, batch_size, 1);
+}
+
+double Bit_T_InterClustered(int bitveclen, int batch_size) {
+  Bit_T b1 = Bit_new(bitveclen);
+  Bit_T b2 = Bit_new(bitveclen);
+  assert(b1 != NULL && b2 != NULL);
+  Bit_aset(b1, g_clust_indices, g_clust_indices_len);
+  Bit_aset(b2, g_clust_indices, g_clust_indices_len);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    Bit_T inter = Bit_inter(b1, b2);
+    assert(inter != NULL);
+    Bit_free(&inter);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  Bit_free(&b1);
+  Bit_free(&b2);
+  return timeElapsed;
+}
+
+double CBitset_InterClustered(int bitveclen, int batch_size) {
+  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+  bitset_t *b2 = bitset_create_with_capacity(bitveclen);
+  assert(b1 != NULL && b2 != NULL);
+  for (int i = 0; i < g_clust_indices_len; i++) {
+    bitset_set(b1, (size_t)g_clust_indices[i]);
+    bitset_set(b2, (size_t)g_clust_indices[i]);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    bitset_t *tmp = bitset_copy(b1);
+    assert(tmp != NULL);
+    bitset_inplace_intersection(tmp, b2);
+    bitset_free(tmp);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  bitset_free(b1);
+  bitset_free(b2);
+  return timeElapsed;
+}
+
+static double croaring_inter_clustered(int bitveclen, int batch_size,
+                                       int run_optimize) {
+  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+  roaring_bitmap_t *r2 = roaring_bitmap_create_with_capacity(bitveclen);
+  assert(r1 != NULL && r2 != NULL);
+  roaring_bitmap_add_many(r1, g_clust_indices_len, g_clust_indices_u32);
+  roaring_bitmap_add_many(r2, g_clust_indices_len, g_clust_indices_u32);
+  if (run_optimize) {
+    roaring_bitmap_run_optimize(r1);
+    roaring_bitmap_run_optimize(r2);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    roaring_bitmap_t *r_and = roaring_bitmap_and(r1, r2);
+    assert(r_and != NULL);
+    roaring_bitmap_free(r_and);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  roaring_bitmap_free(r1);
+  roaring_bitmap_free(r2);
+  return timeElapsed;
+}
+
+double CRoaring_InterClustered(int bitveclen, int batch_size) {
+  return croaring_inter_clustered(bitveclen, batch_size, 0);
+}
+
+double CRoaring_InterClusteredRunOpt(int bitveclen, int batch_size) {
+  return croaring_inter_clustered(bitveclen, batch_size, 1);
+}
+
+double Bit_T_InterCountClustered(int bitveclen, int batch_size) {
+  Bit_T b1 = Bit_new(bitveclen);
+  Bit_T b2 = Bit_new(bitveclen);
+  assert(b1 != NULL && b2 != NULL);
+  Bit_aset(b1, g_clust_indices, g_clust_indices_len);
+  Bit_aset(b2, g_clust_indices, g_clust_indices_len);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    int count = Bit_inter_count(b1, b2);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  Bit_free(&b1);
+  Bit_free(&b2);
+  return timeElapsed;
+}
+
+double CBitset_InterCountClustered(int bitveclen, int batch_size) {
+  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+  bitset_t *b2 = bitset_create_with_capacity(bitveclen);
+  assert(b1 != NULL && b2 != NULL);
+  for (int i = 0; i < g_clust_indices_len; i++) {
+    bitset_set(b1, (size_t)g_clust_indices[i]);
+    bitset_set(b2, (size_t)g_clust_indices[i]);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    size_t count = bitset_intersection_count(b1, b2);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  bitset_free(b1);
+  bitset_free(b2);
+  return timeElapsed;
+}
+
+static double croaring_intercount_clustered(int bitveclen, int batch_size,
+                                            int run_optimize) {
+  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+  roaring_bitmap_t *r2 = roaring_bitmap_create_with_capacity(bitveclen);
+  assert(r1 != NULL && r2 != NULL);
+  roaring_bitmap_add_many(r1, g_clust_indices_len, g_clust_indices_u32);
+  roaring_bitmap_add_many(r2, g_clust_indices_len, g_clust_indices_u32);
+  if (run_optimize) {
+    roaring_bitmap_run_optimize(r1);
+    roaring_bitmap_run_optimize(r2);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(r1);
+    BENCH_ESCAPE(r2);
+    uint64_t count = roaring_bitmap_and_cardinality(r1, r2);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  roaring_bitmap_free(r1);
+  roaring_bitmap_free(r2);
+  return timeElapsed;
+}
+
+double CRoaring_InterCountClustered(int bitveclen, int batch_size) {
+  return croaring_intercount_clustered(bitveclen, batch_size, 0);
+}
+
+double CRoaring_InterCountClusteredRunOpt(int bitveclen, int batch_size) {
+  return croaring_intercount_clustered(bitveclen, batch_size, 1);
+}
+
+/******************************************************************************
+
+* Copy and comparison (all libraries)
+
+******************************************************************************/
+
+// Operands for the comparison benchmarks are built from the uniform indices
+// (with bit 0 removed) in three flavours:
+//   Same      - both operands hold the same bits; every check scans it all
+//   LateDiff  - the first operand lacks the largest id, so the difference
+//               sits in the last populated word/container: equality fails
+//               and the subset checks succeed only after a full scan
+//   EarlyDiff - the first operand also has bit 0, so equality and the subset
+//               checks can exit on the first word/container
+// Bit_T has no copy entry point; Bit_T_Copy allocates a Bit_buffer_size()
+// buffer, copies the words out with Bit_extract and wraps them with Bit_load,
+// which matches what bitset_copy and roaring_bitmap_copy do. Every comparison
+// is checked once, untimed, against the answer its variant must give.
+
+typedef enum cmp_op { CMP_EQ, CMP_SUBSET, CMP_STRICT_SUBSET } cmp_op_t;
+typedef enum cmp_variant {
+  CMP_SAME,
+  CMP_LATE_DIFF,
+  CMP_EARLY_DIFF
+} cmp_variant_t;
+
+// Fills a/b (each with room for g_rand_indices_len + 1 entries) and returns
+// their lengths through na/nb.
+static void cmp_operands(int bitveclen, cmp_variant_t variant, int *a, int *na,
+                         int *b, int *nb) {
+  int n = 0, max_id = 0;
+  for (int i = 0; i < g_rand_indices_len; i++) {
+    if (g_rand_indices[i] != 0)
+      a[n++] = g_rand_indices[i];
+    if (g_rand_indices[i] > max_id)
+      max_id = g_rand_indices[i];
+  }
+  memcpy(b, a, sizeof(int) * (size_t)n);
+  *na = *nb = n;
+  if (variant == CMP_LATE_DIFF) {
+    // drop every copy of the largest id; it stays inside the populated range
+    // so no layout can tell the operands apart by their extent
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+      if (a[i] != max_id)
+        a[m++] = a[i];
+    }
+    *na = m;
+  } else if (variant == CMP_EARLY_DIFF) {
+    a[(*na)++] = 0;
+  }
+}
+
+// Expected result of each comparison on each operand variant
+static int cmp_expected(cmp_op_t op, cmp_variant_t variant) {
+  switch (variant) {
+  case CMP_SAME:
+    return op != CMP_STRICT_SUBSET;
+  case CMP_LATE_DIFF:
+    return op != CMP_EQ;
+  default:
+    return 0;
+  }
+}
+
+double Bit_T_Copy(int bitveclen, int batch_size) {
+  Bit_T b1 = Bit_new(bitveclen);
+  assert(b1 != NULL);
+  Bit_aset(b1, g_rand_indices, g_rand_indices_len);
+  size_t bytes = (size_t)Bit_buffer_size(bitveclen);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    void *buf = malloc(bytes);
+    assert(buf != NULL);
+    Bit_extract(b1, buf);
+    Bit_T copy = Bit_load(bitveclen, buf);
+    assert(copy != NULL);
+    BENCH_ESCAPE(copy);
+    Bit_free(&copy);
+    free(buf);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  Bit_free(&b1);
+  return timeElapsed;
+}
+
+double CBitset_Copy(int bitveclen, int batch_size) {
+  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+  assert(b1 != NULL);
+  for (int i = 0; i < g_rand_indices_len; i++) {
+    bitset_set(b1, (size_t)g_rand_indices[i]);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    bitset_t *copy = bitset_copy(b1);
+    assert(copy != NULL);
+    bitset_free(copy);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  bitset_free(b1);
+  return timeElapsed;
+}
+
+double CRoaring_Copy(int bitveclen, int batch_size) {
+  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+  assert(r1 != NULL);
+  roaring_bitmap_add_many(r1, g_rand_indices_len, g_rand_indices_u32);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    roaring_bitmap_t *copy = roaring_bitmap_copy(r1);
+    assert(copy != NULL);
+    roaring_bitmap_free(copy);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  roaring_bitmap_free(r1);
+  return timeElapsed;
+}
+
+static int bit_t_cmp(Bit_T b1, Bit_T b2, cmp_op_t op) {
+  return op == CMP_EQ       ? Bit_eq(b1, b2)
+         : op == CMP_SUBSET ? Bit_leq(b1, b2)
+                            : Bit_lt(b1, b2);
+}
+
+static double bit_t_compare(int bitveclen, int batch_size, cmp_op_t op,
+                            cmp_variant_t variant) {
+  int *a = (int *)malloc(sizeof(int) * (size_t)(g_rand_indices_len + 1));
+  int *b = (int *)malloc(sizeof(int) * (size_t)(g_rand_indices_len + 1));
+  assert(a != NULL && b != NULL);
+  int na, nb;
+  cmp_operands(bitveclen, variant, a, &na, b, &nb);
+  Bit_T b1 = Bit_new(bitveclen);
+  Bit_T b2 = Bit_new(bitveclen);
+  assert(b1 != NULL && b2 != NULL);
+  Bit_aset(b1, a, na);
+  Bit_aset(b2, b, nb);
+  assert(!bit_t_cmp(b1, b2, op) == !cmp_expected(op, variant));
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    int res = bit_t_cmp(b1, b2, op);
+    BENCH_DO_NOT_OPTIMIZE(res);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  Bit_free(&b1);
+  Bit_free(&b2);
+  free(a);
+  free(b);
+  return timeElapsed;
+}
+
+// CBitset has no comparison API; compare the word arrays directly, exiting at
+// the first word that decides the answer.
+static int cbitset_equal(const bitset_t *b1, const bitset_t *b2) {
+  return b1->arraysize == b2->arraysize &&
+         memcmp(b1->array, b2->array, b1->arraysize * sizeof(uint64_t)) == 0;
+}
+
+static int cbitset_subset(const bitset_t *b1, const bitset_t *b2, int strict) {
+  size_t n = b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
+  int proper = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (b1->array[i] & ~b2->array[i])
+      return 0;
+    proper |= b1->array[i] != b2->array[i];
+  }
+  for (size_t i = n; i < b1->arraysize; i++) {
+    if (b1->array[i])
+      return 0;
+  }
+  for (size_t i = n; i < b2->arraysize && !proper; i++) {
+    proper = b2->array[i] != 0;
+  }
+  return strict ? proper : 1;
+}
+
+static int cbitset_cmp(const bitset_t *b1, const bitset_t *b2, cmp_op_t op) {
+  return op == CMP_EQ ? cbitset_equal(b1, b2)
+                      : cbitset_subset(b1, b2, op == CMP_STRICT_SUBSET);
+}
+
+static double cbitset_compare(int bitveclen, int batch_size, cmp_op_t op,
+                              cmp_variant_t variant) {
+  int *a = (int *)malloc(sizeof(int) * (size_t)(g_rand_indices_len + 1));
+  int *b = (int *)malloc(sizeof(int) * (size_t)(g_rand_indices_len + 1));
+  assert(a != NULL && b != NULL);
+  int na, nb;
+  cmp_operands(bitveclen, variant, a, &na, b, &nb);
+  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+  bitset_t *b2 = bitset_create_with_capacity(bitveclen);
+  assert(b1 != NULL && b2 != NULL);
+  for (int i = 0; i < na; i++) {
+    bitset_set(b1, (size_t)a[i]);
+  }
+  for (int i = 0; i < nb; i++) {
+    bitset_set(b2, (size_t)b[i]);
+  }
+  assert(cbitset_cmp(b1, b2, op) == cmp_expected(op, variant));
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    int res = cbitset_cmp(b1, b2, op);
+    BENCH_DO_NOT_OPTIMIZE(res);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  bitset_free(b1);
+  bitset_free(b2);
+  free(a);
+  free(b);
+  return timeElapsed;
+}
+
+static bool croaring_cmp(const roaring_bitmap_t *r1,
+                         const roaring_bitmap_t *r2, cmp_op_t op) {
+  return op == CMP_EQ       ? roaring_bitmap_equals(r1, r2)
+         : op == CMP_SUBSET ? roaring_bitmap_is_subset(r1, r2)
+                            : roaring_bitmap_is_strict_subset(r1, r2);
+}
+
+static double croaring_compare(int bitveclen, int batch_size, cmp_op_t op,
+                               cmp_variant_t variant) {
+  int *a = (int *)malloc(sizeof(int) * (size_t)(g_rand_indices_len + 1));
+  int *b = (int *)malloc(sizeof(int) * (size_t)(g_rand_indices_len + 1));
+  assert(a != NULL && b != NULL);
+  int na, nb;
+  cmp_operands(bitveclen, variant, a, &na, b, &nb);
+  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+  roaring_bitmap_t *r2 = roaring_bitmap_create_with_capacity(bitveclen);
+  assert(r1 != NULL && r2 != NULL);
+  roaring_bitmap_add_many(r1, na, (const uint32_t *)a);
+  roaring_bitmap_add_many(r2, nb, (const uint32_t *)b);
+  assert(croaring_cmp(r1, r2, op) == (bool)cmp_expected(op, variant));
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(r1);
+    BENCH_ESCAPE(r2);
+    bool res = croaring_cmp(r1, r2, op);
+    BENCH_DO_NOT_OPTIMIZE(res);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  roaring_bitmap_free(r1);
+  roaring_bitmap_free(r2);
+  free(a);
+  free(b);
+  return timeElapsed;
+}
+
+#define COMPARE_BENCHMARKS(library, helper)                                    \
+  double library##_EqSame(int bitveclen, int batch_size) {                     \
+    return helper(bitveclen, batch_size, CMP_EQ, CMP_SAME);                    \
+  }                                                                            \
+  double library##_EqLateDiff(int bitveclen, int batch_size) {                 \
+    return helper(bitveclen, batch_size, CMP_EQ, CMP_LATE_DIFF);               \
+  }                                                                            \
+  double library##_EqEarlyDiff(int bitveclen, int batch_size) {                \
+    return helper(bitveclen, batch_size, CMP_EQ, CMP_EARLY_DIFF);              \
+  }                                                                            \
+  double library##_SubsetSame(int bitveclen, int batch_size) {                 \
+    return helper(bitveclen, batch_size, CMP_SUBSET, CMP_SAME);                \
+  }                                                                            \
+  double library##_SubsetLateDiff(int bitveclen, int batch_size) {             \
+    return helper(bitveclen, batch_size, CMP_SUBSET, CMP_LATE_DIFF);           \
+  }                                                                            \
+  double library##_SubsetEarlyDiff(int bitveclen, int batch_size) {            \
+    return helper(bitveclen, batch_size, CMP_SUBSET, CMP_EARLY_DIFF);          \
+  }                                                                            \
+  double library##_StrictSubsetSame(int bitveclen, int batch_size) {           \
+    return helper(bitveclen, batch_size, CMP_STRICT_SUBSET, CMP_SAME);         \
+  }                                                                            \
+  double library##_StrictSubsetLateDiff(int bitveclen, int batch_size) {       \
+    return helper(bitveclen, batch_size, CMP_STRICT_SUBSET, CMP_LATE_DIFF);    \
+  }                                                                            \
+  double library##_StrictSubsetEarlyDiff(int bitveclen, int batch_size) {      \
+    return helper(bitveclen, batch_size, CMP_STRICT_SUBSET, CMP_EARLY_DIFF);   \
+  }
+
+COMPARE_BENCHMARKS(Bit_T, bit_t_compare)
+COMPARE_BENCHMARKS(CBitset, cbitset_compare)
+COMPARE_BENCHMARKS(CRoaring, croaring_compare)
+
+/******************************************************************************
+
+* Crossover search
+
+******************************************************************************/
+
+// For every operation, find where the fastest representation changes as a
+// function of bit length (at fixed densities) and of density (at fixed
+// lengths). A coarse power-of-two grid is sampled first, then every pair of
+// neighbouring samples with different winners is bisected on a log scale
+// until the bracket is narrower than XO_TOL. The result is a decision table
+// of (operation, axis, fixed value, from, to, winner) intervals.
+
+typedef enum xo_op { XO_POPCOUNT, XO_INTER, XO_INTERCOUNT, XO_NUM_OPS } xo_op_t;
+typedef enum xo_lib {
+  XO_BIT_T,
+  XO_CBITSET,
+  XO_CROARING,
+  XO_CROARING_RUN,
+  XO_SORTED,
+  XO_NUM_LIBS
+} xo_lib_t;
+
+static const char *xo_op_names[XO_NUM_OPS] = {"PopCount", "Inter",
+                                              "InterCount"};
+static const char *xo_lib_names[XO_NUM_LIBS] = {
+    "Bit_T", "CBitset", "CRoaring", "CRoaring_RunOpt", "SortedArr"};
+
+#define XO_TOL 1.15        // stop bisecting when hi/lo drops below this
+#define XO_TIE 1.03        // times within 3% of the best count as a tie
+#define XO_REPS 5          // timed repetitions per sample (median is used)
+#define XO_MAX_SAMPLES 256 // per bisection axis
+#define XO_RECHECK 2       // re-measurements of a sample that forms an island
+#define XO_MIN_DENSITY 0.001
+#define XO_MAX_DENSITY 0.5
+
+static const double xo_densities[] = {0.001, 0.01, 0.05, 0.1, 0.25, 0.5};
+
+typedef struct xo_data {
+  int bitveclen;
+  int n;
+  int *a; // n distinct operand indices, uniform in [0, bitveclen)
+  int *b;
+} xo_data_t;
+
+typedef struct xo_sample {
+  double x;
+  int winner;
+} xo_sample_t;
+
+// Draw n distinct ids from [0, bitveclen) by selection sampling (Knuth's
+// Algorithm S), then shuffle them so they are not inserted in order. Drawing
+// with replacement would leave the realized density below the nominal one.
+static void xo_sample_ids(int *ids, int n, int bitveclen) {
+  int need = n;
+  int k = 0;
+  for (int i = 0; i < bitveclen && need > 0; i++) {
+    double u = rand() / ((double)RAND_MAX + 1.0);
+    if (u * (bitveclen - i) < need) {
+      ids[k++] = i;
+      need--;
+    }
+  }
+  assert(k == n);
+  for (int i = n - 1; i > 0; i--) {
+    int j = rand() % (i + 1);
+    int tmp = ids[i];
+    ids[i] = ids[j];
+    ids[j] = tmp;
+  }
+}
+
+static void xo_data_init(xo_data_t *d, int bitveclen, double density) {
+  d->bitveclen = bitveclen;
+  d->n = (int)(density * bitveclen);
+  if (d->n < 1)
+    d->n = 1;
+  d->a = (int *)malloc(sizeof(int) * (size_t)d->n);
+  d->b = (int *)malloc(sizeof(int) * (size_t)d->n);
+  assert(d->a != NULL && d->b != NULL);
+  srand(g_seed);
+  xo_sample_ids(d->a, d->n, bitveclen);
+  xo_sample_ids(d->b, d->n, bitveclen);
+}
+
+static void xo_data_free(xo_data_t *d) {
+  free(d->a);
+  free(d->b);
+  d->a = d->b = NULL;
+}
+
+static int cmp_double(const void *x, const void *y) {
+  double a = *(const double *)x, b = *(const double *)y;
+  return (a > b) - (a < b);
+}
+
+// Median seconds per batch of `op` on representation `lib` built from d.
+static double xo_time(xo_lib_t lib, xo_op_t op, const xo_data_t *d,
+                      int batch_size) {
+  double t[XO_REPS];
+  void *x = NULL, *y = NULL;
+  uint16_t *scratch = NULL;
+
+  switch (lib) {
+  case XO_BIT_T: {
+    Bit_T b1 = Bit_new(d->bitveclen), b2 = Bit_new(d->bitveclen);
+    assert(b1 != NULL && b2 != NULL);
+    Bit_aset(b1, d->a, d->n);
+    Bit_aset(b2, d->b, d->n);
+    x = b1;
+    y = b2;
+    break;
+  }
+  case XO_CBITSET: {
+    bitset_t *b1 = bitset_create_with_capacity(d->bitveclen);
+    bitset_t *b2 = bitset_create_with_capacity(d->bitveclen);
+    assert(b1 != NULL && b2 != NULL);
+    for (int i = 0; i < d->n; i++) {
+      bitset_set(b1, (size_t)d->a[i]);
+      bitset_set(b2, (size_t)d->b[i]);
+    }
+    x = b1;
+    y = b2;
+    break;
+  }
+  case XO_CROARING:
+  case XO_CROARING_RUN: {
+    roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(d->bitveclen);
+    roaring_bitmap_t *r2 = roaring_bitmap_create_with_capacity(d->bitveclen);
+    assert(r1 != NULL && r2 != NULL);
+    roaring_bitmap_add_many(r1, d->n, (const uint32_t *)d->a);
+    roaring_bitmap_add_many(r2, d->n, (const uint32_t *)d->b);
+    if (lib == XO_CROARING_RUN) {
+      roaring_bitmap_run_optimize(r1);
+      roaring_bitmap_run_optimize(r2);
+    }
+    x = r1;
+    y = r2;
+    break;
+  }
+  case XO_SORTED: {
+    sorted_ids_t *s1 = sorted_ids_new(d->n), *s2 = sorted_ids_new(d->n);
+    scratch = (uint16_t *)malloc(((size_t)d->n + SORTED_SIMD_PAD) *
+                                 sizeof(uint16_t));
+    assert(s1 != NULL && s2 != NULL && scratch != NULL);
+    sorted_ids_fill(s1, (const uint32_t *)d->a, d->n);
+    sorted_ids_fill(s2, (const uint32_t *)d->b, d->n);
+    x = s1;
+    y = s2;
+    break;
+  }
+  default:
+    assert(0);
+  }
+
+  for (int rep = 0; rep < XO_REPS; rep++) {
+    bench_stamp_t start_time, end_time;
+    bench_timer_start(&start_time);
+    for (int i = 0; i < batch_size; i++) {
+      BENCH_ESCAPE(x);
+      BENCH_ESCAPE(y);
+      if (lib == XO_BIT_T) {
+        if (op == XO_POPCOUNT) {
+          int count = Bit_count((Bit_T)x);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        } else if (op == XO_INTER) {
+          Bit_T inter = Bit_inter((Bit_T)x, (Bit_T)y);
+          Bit_free(&inter);
+        } else {
+          int count = Bit_inter_count((Bit_T)x, (Bit_T)y);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        }
+      } else if (lib == XO_CBITSET) {
+        if (op == XO_POPCOUNT) {
+          size_t count = bitset_count((bitset_t *)x);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        } else if (op == XO_INTER) {
+          bitset_t *tmp = bitset_copy((bitset_t *)x);
+          bitset_inplace_intersection(tmp, (bitset_t *)y);
+          bitset_free(tmp);
+        } else {
+          size_t count = bitset_intersection_count((bitset_t *)x, (bitset_t *)y);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        }
+      } else if (lib == XO_SORTED) {
+        sorted_ids_t *s1 = (sorted_ids_t *)x, *s2 = (sorted_ids_t *)y;
+        if (op == XO_POPCOUNT) {
+          int count = sorted_ids_count(s1);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        } else if (op == XO_INTER) {
+          uint32_t *out =
+              (uint32_t *)malloc(((size_t)s1->n + 1) * sizeof(uint32_t));
+          int n = sorted_ids_inter(s1, s2, out, scratch);
+          BENCH_DO_NOT_OPTIMIZE(n);
+          free(out);
+        } else {
+          size_t count = sorted_ids_inter_count(s1, s2);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        }
+      } else {
+        if (op == XO_POPCOUNT) {
+          uint64_t count = roaring_bitmap_get_cardinality(x);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        } else if (op == XO_INTER) {
+          roaring_bitmap_t *r_and = roaring_bitmap_and(x, y);
+          roaring_bitmap_free(r_and);
+        } else {
+          uint64_t count = roaring_bitmap_and_cardinality(x, y);
+          BENCH_DO_NOT_OPTIMIZE(count);
+        }
+      }
+    }
+    bench_timer_stop(&end_time);
+    t[rep] = bench_timer_elapsed(&end_time, &start_time);
+  }
+
+  if (lib == XO_BIT_T) {
+    Bit_free((Bit_T *)&x);
+    Bit_free((Bit_T *)&y);
+  } else if (lib == XO_CBITSET) {
+    bitset_free(x);
+    bitset_free(y);
+  } else if (lib == XO_SORTED) {
+    sorted_ids_free(x);
+    sorted_ids_free(y);
+    free(scratch);
+  } else {
+    roaring_bitmap_free(x);
+    roaring_bitmap_free(y);
+  }
+
+  qsort(t, XO_REPS, sizeof(double), cmp_double);
+  return t[XO_REPS / 2];
+}
+
+// Index of the fastest representation for op at (bitveclen, density). Ties
+// (within XO_TIE) go to the representation listed first, so that timing noise
+// between near-equal candidates does not fragment the decision table.
+static int xo_winner(xo_op_t op, int bitveclen, double density,
+                     int batch_size) {
+  xo_data_t d;
+  xo_data_init(&d, bitveclen, density);
+  double t[XO_NUM_LIBS];
+  double best_t = -1.0;
+  for (int lib = 0; lib < XO_NUM_LIBS; lib++) {
+    t[lib] = xo_time((xo_lib_t)lib, op, &d, batch_size);
+    if (best_t < 0.0 || t[lib] < best_t)
+      best_t = t[lib];
+  }
+  xo_data_free(&d);
+  int best = 0;
+  while (t[best] > best_t * XO_TIE)
+    best++;
+  return best;
+}
+
+typedef struct xo_axis {
+  xo_op_t op;
+  int by_length;  // 1: x is the bit length, 0: x is the density
+  double fixed;   // density (by_length) or bit length (by density)
+  int batch_size;
+  xo_sample_t s[XO_MAX_SAMPLES];
+  int ns;
+} xo_axis_t;
+
+static int xo_eval(xo_axis_t *ax, double x) {
+  if (ax->by_length)
+    return xo_winner(ax->op, (int)x, ax->fixed, ax->batch_size);
+  return xo_winner(ax->op, (int)ax->fixed, x, ax->batch_size);
+}
+
+static void xo_push(xo_axis_t *ax, double x, int winner) {
+  if (ax->ns < XO_MAX_SAMPLES) {
+    ax->s[ax->ns].x = x;
+    ax->s[ax->ns].winner = winner;
+    ax->ns++;
+  }
+}
+
+static void xo_refine(xo_axis_t *ax, double lo, int wlo, double hi, int whi) {
+  if (wlo == whi || hi / lo < XO_TOL || ax->ns >= XO_MAX_SAMPLES)
+    return;
+  double mid = sqrt(lo * hi);
+  if (ax->by_length) {
+    mid = (double)(int)mid;
+    if (mid <= lo || mid >= hi)
+      return;
+  }
+  int wmid = xo_eval(ax, mid);
+  xo_push(ax, mid, wmid);
+  xo_refine(ax, lo, wlo, mid, wmid);
+  xo_refine(ax, mid, wmid, hi, whi);
+}
+
+static int cmp_sample(const void *x, const void *y) {
+  double a = ((const xo_sample_t *)x)->x, b = ((const xo_sample_t *)y)->x;
+  return (a > b) - (a < b);
+}
+
+// A sample whose winner differs from both of its (agreeing) neighbours would
+// become a one-sample row in the table, which is usually timing noise. Measure
+// it XO_RECHECK more times; it keeps its winner only if every re-measurement
+// confirms it, otherwise it is folded into its neighbours.
+static void xo_settle_islands(xo_axis_t *ax) {
+  for (int i = 1; i + 1 < ax->ns; i++) {
+    int w = ax->s[i - 1].winner;
+    if (ax->s[i + 1].winner != w || ax->s[i].winner == w)
+      continue;
+    int confirmed = 1;
+    for (int r = 0; r < XO_RECHECK && confirmed; r++)
+      confirmed = xo_eval(ax, ax->s[i].x) == ax->s[i].winner;
+    if (!confirmed)
+      ax->s[i].winner = w;
+  }
+}
+
+// Sample the coarse grid [lo, hi] (doubling), bisect between neighbours with
+// different winners, settle one-sample islands and write the resulting
+// intervals.
+static void xo_search(xo_axis_t *ax, double lo, double hi, FILE *f) {
+  xo_sample_t grid[64];
+  int ng = 0;
+  for (double x = lo; ng < 64; x *= 2.0) {
+    if (x > hi)
+      x = hi;
+    grid[ng].x = x;
+    grid[ng].winner = xo_eval(ax, x);
+    xo_push(ax, x, grid[ng].winner);
+    ng++;
+    if (x >= hi)
+      break;
+  }
+  for (int i = 1; i < ng; i++) {
+    xo_refine(ax, grid[i - 1].x, grid[i - 1].winner, grid[i].x,
+              grid[i].winner);
+  }
+  qsort(ax->s, ax->ns, sizeof(xo_sample_t), cmp_sample);
+  xo_settle_islands(ax);
+
+  int start = 0;
+  for (int i = 1; i <= ax->ns; i++) {
+    if (i == ax->ns || ax->s[i].winner != ax->s[start].winner) {
+      fprintf(f, "%s,%s,%g,%g,%g,%s\n", xo_op_names[ax->op],
+              ax->by_length ? "bitveclen" : "density", ax->fixed,
+              ax->s[start].x, ax->s[i - 1].x,
+              xo_lib_names[ax->s[start].winner]);
+      printf("  %-10s %-9s @ %-8g %10g .. %-10g -> %s\n", xo_op_names[ax->op],
+             ax->by_length ? "bitveclen" : "density", ax->fixed,
+             ax->s[start].x, ax->s[i - 1].x,
+             xo_lib_names[ax->s[start].winner]);
+      start = i;
+    }
+  }
+}
+
+// ./benchmark crossover <min bitveclen> <max bitveclen> <batch_size> [seed]
+int run_crossover(int argc, char *argv[]) {
+  if (argc != 5 && argc != 6) {
+    puts("Usage: ./benchmark crossover <min bitveclen> <max bitveclen> "
+         "<batch_size> [seed]");
+    return 1;
+  }
+  int min_len = atoi(argv[2]);
+  int max_len = atoi(argv[3]);
+  int batch_size = atoi(argv[4]);
+  g_seed = (argc == 6) ? (unsigned int)strtoul(argv[5], NULL, 10) : 100u;
+  assert(min_len > 0 && max_len >= min_len);
+  assert(batch_size > 0);
+
+  char cpu[256];
+  assert(get_cpu_model(cpu, sizeof cpu) == 0);
+  char outfile[512];
+  snprintf(outfile, sizeof outfile,
+           "results_crossover/crossover_Length%d-%d_Batch%d_CPU%s.csv",
+           min_len, max_len, batch_size, cpu);
+  mkdir("results_crossover", 0755);
+  FILE *f = fopen(outfile, "w");
+  if (!f) {
+    fprintf(stderr, "Error opening file %s for writing\n", outfile);
+    return 1;
+  }
+  fprintf(f, "operation,axis,fixed,from,to,winner\n");
+
+  bench_timer_init(batch_size);
+  printf("Crossover search for bit lengths %d..%d, batch size %d on CPU: %s\n",
+         min_len, max_len, batch_size, cpu);
+
+  static xo_axis_t ax; // large; keep off the stack
+  for (int op = 0; op < XO_NUM_OPS; op++) {
+    for (size_t i = 0; i < sizeof xo_densities / sizeof xo_densities[0];
+         i++) {
+      ax.op = (xo_op_t)op;
+      ax.by_length = 1;
+      ax.fixed = xo_densities[i];
+      ax.batch_size = batch_size;
+      ax.ns = 0;
+      xo_search(&ax, min_len, max_len, f);
+    }
+    for (double len = min_len; len <= max_len; len *= 4.0) {
+      ax.op = (xo_op_t)op;
+      ax.by_length = 0;
+      ax.fixed = (int)len;
+      ax.batch_size = batch_size;
+      ax.ns = 0;
+      xo_search(&ax, XO_MIN_DENSITY, XO_MAX_DENSITY, f);
+    }
+  }
+
+  fclose(f);
+  printf("Decision table written to %s\n", outfile);
+  return 0;
+}
+
+/******************************************************************************
+
+* Memory backing
+
+******************************************************************************/
+
+// Does the memory behind a large bitvector matter? The same bits are placed in
+// buffers of every bench_backing_t and both word-array libraries run over
+// them: bitset_t is a public struct that is pointed at the buffer, and
+// Bit_load wraps the buffer as a Bit_T without copying it. PopCount and
+// InterCount of identical operands do not depend on the bit order inside a
+// word, so the two libraries share each buffer. "library" is the allocation
+// each library makes itself; run the subcommand under
+// GLIBC_TUNABLES=glibc.malloc.hugetlb=1 (THP) or =2 (MAP_HUGETLB) to put
+// those allocations on huge pages as well, as batch_run.sh does.
+
+typedef enum mem_op { MEM_POPCOUNT, MEM_INTERCOUNT, MEM_NUM_OPS } mem_op_t;
+
+static const char *mem_op_names[MEM_NUM_OPS] = {"PopCount", "InterCount"};
+static const char *bench_backing_names[BENCH_BACKING_COUNT] = {
+    "malloc", "aligned64", "misaligned", "thp", "hugetlb"};
+
+// Backing that was actually obtained; a thp request whose mapping ended up
+// without any AnonHugePages is reported as thp-4k.
+static const char *mem_obtained(const bench_buffer_t *b) {
+  if (b->backing == BENCH_BACKING_THP && b->huge_kb == 0)
+    return "thp-4k";
+  return bench_backing_names[b->backing];
+}
+
+typedef struct mem_operands {
+  bench_buffer_t buf[2];
+  bitset_t set[2]; // views of buf, never passed to bitset_free
+  Bit_T bit[2];    // Bit_load views of buf; the buffers stay ours
+} mem_operands_t;
+
+static int mem_operands_init(mem_operands_t *m, int bitveclen,
+                             bench_backing_t backing) {
+  size_t words = ((size_t)bitveclen + 63) / 64;
+  size_t bytes = words * sizeof(uint64_t);
+  if ((size_t)Bit_buffer_size(bitveclen) > bytes)
+    bytes = (size_t)Bit_buffer_size(bitveclen);
+  for (int k = 0; k < 2; k++) {
+    if (bench_buffer_alloc(&m->buf[k], bytes, backing) != 0)
+      return -1;
+    uint64_t *w = (uint64_t *)m->buf[k].ptr;
+    for (int i = 0; i < g_rand_indices_len; i++) {
+      w[g_rand_indices[i] / 64] |= UINT64_C(1) << (g_rand_indices[i] % 64);
+    }
+    m->set[k].array = w;
+    m->set[k].arraysize = words;
+    m->set[k].capacity = words;
+    m->bit[k] = Bit_load(bitveclen, w);
+    if (!m->bit[k])
+      return -1;
+  }
+  return 0;
+}
+
+static void mem_operands_free(mem_operands_t *m) {
+  for (int k = 0; k < 2; k++) {
+    if (m->bit[k])
+      Bit_free(&m->bit[k]);
+    bench_buffer_free(&m->buf[k]);
+  }
+}
+
+static double mem_time_cbitset(const bitset_t *b1, const bitset_t *b2,
+                               mem_op_t op, int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    size_t count = op == MEM_POPCOUNT ? bitset_count(b1)
+                                      : bitset_intersection_count(b1, b2);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
+
+static double mem_time_bit_t(Bit_T b1, Bit_T b2, mem_op_t op,
+                             int batch_size) {
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < batch_size; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    int count = op == MEM_POPCOUNT ? Bit_count(b1) : Bit_inter_count(b1, b2);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+  return timeElapsed;
+}
+
+static double mem_median(double *x, int n) {
+  qsort(x, (size_t)n, sizeof *x, cmp_double);
+  return n % 2 ? x[n / 2] : 0.5 * (x[n / 2 - 1] + x[n / 2]);
+}
+
+// Columns of the timing table: every backing for CBitset, every backing for
+// Bit_T, then the library-allocated CBitset and Bit_T.
+enum { MEM_COLS = 2 * BENCH_BACKING_COUNT + 2 };
+
+static int mem_col_is_bit_t(int col) {
+  return col == MEM_COLS - 1 ||
+         (col >= BENCH_BACKING_COUNT && col < 2 * BENCH_BACKING_COUNT);
+}
+
+// backing index of col, or -1 for the library's own allocation
+static int mem_col_backing(int col) {
+  return col < 2 * BENCH_BACKING_COUNT ? col % BENCH_BACKING_COUNT : -1;
+}
+
+// ./benchmark memory <bitveclen> <num of iterations> <batch_size> [seed]
+int run_memory(int argc, char *argv[]) {
+  if (argc != 5 && argc != 6) {
+    puts("Usage: ./benchmark memory <bitveclen> <num of iterations> "
+         "<batch_size> [seed]");
+    return 1;
+  }
+  int bitveclen = atoi(argv[2]);
+  int num_of_iterations = atoi(argv[3]);
+  int batch_size = atoi(argv[4]);
+  g_seed = (argc == 6) ? (unsigned int)strtoul(argv[5], NULL, 10) : 100u;
+  assert(bitveclen > 0);
+  assert(batch_size > 0);
+  assert(num_of_iterations > 0);
+  if (open_dataset(bitveclen) != 0) {
+    return 1;
+  }
+
+  char cpu[256];
+  assert(get_cpu_model(cpu, sizeof cpu) == 0);
+  const char *tunables = getenv("GLIBC_TUNABLES");
+  if (!tunables || !*tunables)
+    tunables = "none";
+  char thp[128] = "unknown";
+  FILE *thp_f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if (thp_f) {
+    if (fgets(thp, sizeof thp, thp_f))
+      thp[strcspn(thp, "\n")] = '\0';
+    fclose(thp_f);
+  }
+  // active mode, e.g. "madvise" out of "always [madvise] never"
+  char thp_mode[32] = "unknown";
+  const char *open_br = strchr(thp, '[');
+  if (open_br && strchr(open_br, ']'))
+    snprintf(thp_mode, sizeof thp_mode, "%.*s",
+             (int)(strchr(open_br, ']') - open_br - 1), open_br + 1);
+
+  char outfile[512];
+  snprintf(outfile, sizeof outfile,
+           "results_memory/benchmark_memory_Length%d_Batch%d_Tunables%s_CPU%s"
+           ".csv",
+           bitveclen, batch_size,
+           strcmp(tunables, "none") == 0 ? "none"
+           : strstr(tunables, "hugetlb=2") ? "hugetlb"
+           : strstr(tunables, "hugetlb=1") ? "thp"
+                                           : "other",
+           cpu);
+  mkdir("results_memory", 0755);
+  FILE *f = fopen(outfile, "w");
+  if (!f) {
+    fprintf(stderr, "Error opening file %s for writing\n", outfile);
+    return 1;
+  }
+  fprintf(f, "library,operation,backing,obtained,huge_kb,thp,tunables,"
+             "iteration,seconds,ns_per_op\n");
+
+  bench_timer_init(batch_size);
+  printf("Memory backing experiment for bit length %d (%.1f MB per operand), "
+         "%d iterations with batch size %d on CPU: %s\n"
+         "THP: %s, GLIBC_TUNABLES: %s\n",
+         bitveclen, bitveclen / 8.0 / (1024.0 * 1024.0), num_of_iterations,
+         batch_size, cpu, thp, tunables);
+
+  init_random_indices(bitveclen, bitveclen / 10);
+  static mem_operands_t operands[BENCH_BACKING_COUNT];
+  for (int k = 0; k < BENCH_BACKING_COUNT; k++) {
+    if (mem_operands_init(&operands[k], bitveclen, (bench_backing_t)k) != 0) {
+      fprintf(stderr, "Could not allocate %s buffers\n",
+              bench_backing_names[k]);
+      return 1;
+    }
+    if (strcmp(mem_obtained(&operands[k].buf[0]), bench_backing_names[k]))
+      fprintf(stderr, "%s buffers obtained as %s (%ld kB on huge pages)\n",
+              bench_backing_names[k], mem_obtained(&operands[k].buf[0]),
+              operands[k].buf[0].huge_kb);
+    assert((size_t)Bit_count(operands[k].bit[0]) ==
+           bitset_count(&operands[k].set[0]));
+  }
+  bitset_t *lib_b1 = bitset_create_with_capacity((size_t)bitveclen);
+  bitset_t *lib_b2 = bitset_create_with_capacity((size_t)bitveclen);
+  Bit_T bit_b1 = Bit_new(bitveclen);
+  Bit_T bit_b2 = Bit_new(bitveclen);
+  assert(lib_b1 != NULL && lib_b2 != NULL && bit_b1 != NULL &&
+         bit_b2 != NULL);
+  for (int i = 0; i < g_rand_indices_len; i++) {
+    bitset_set(lib_b1, (size_t)g_rand_indices[i]);
+    bitset_set(lib_b2, (size_t)g_rand_indices[i]);
+  }
+  Bit_aset(bit_b1, g_rand_indices, g_rand_indices_len);
+  Bit_aset(bit_b2, g_rand_indices, g_rand_indices_len);
+
+  double *ns = (double *)malloc(sizeof(double) * MEM_NUM_OPS * MEM_COLS *
+                                (size_t)num_of_iterations);
+  assert(ns != NULL);
+#define MEM_NS(op, col, it) ns[((op) * MEM_COLS + (col)) * num_of_iterations + (it)]
+
+  // Backings are interleaved within every iteration so that slow drift
+  // (frequency, other tenants) hits all of them alike.
+  for (int it = 0; it < num_of_iterations; it++) {
+    for (int op = 0; op < MEM_NUM_OPS; op++) {
+      for (int col = 0; col < MEM_COLS; col++) {
+        double s;
+        int is_bit_t = mem_col_is_bit_t(col);
+        int k = mem_col_backing(col);
+        const char *library = is_bit_t ? "Bit_T" : "CBitset";
+        const char *backing = k >= 0 ? bench_backing_names[k] : "library";
+        const char *obtained =
+            k >= 0 ? mem_obtained(&operands[k].buf[0]) : "library";
+        char huge_kb[32] = "NA";
+        if (k >= 0 && operands[k].buf[0].huge_kb >= 0)
+          snprintf(huge_kb, sizeof huge_kb, "%ld", operands[k].buf[0].huge_kb);
+        if (k >= 0 && is_bit_t) {
+          s = mem_time_bit_t(operands[k].bit[0], operands[k].bit[1],
+                             (mem_op_t)op, batch_size);
+        } else if (k >= 0) {
+          s = mem_time_cbitset(&operands[k].set[0], &operands[k].set[1],
+                               (mem_op_t)op, batch_size);
+        } else if (is_bit_t) {
+          s = mem_time_bit_t(bit_b1, bit_b2, (mem_op_t)op, batch_size);
+        } else {
+          s = mem_time_cbitset(lib_b1, lib_b2, (mem_op_t)op, batch_size);
+        }
+        MEM_NS(op, col, it) = bench_ns_per_op(s, batch_size);
+        fprintf(f, "%s,%s,%s,%s,%s,%s,%s,%d,%.9f,%.3f\n", library,
+                mem_op_names[op], backing, obtained, huge_kb, thp_mode,
+                tunables, it, s, MEM_NS(op, col, it));
+      }
+    }
+  }
+  fclose(f);
+
+  // Summary: median ns per operation, relative to the same library's
+  // aligned64 buffers
+  printf("%-8s %-11s %-14s %12s %9s\n", "library", "operation", "backing",
+         "ns_per_op", "vs_align");
+  for (int op = 0; op < MEM_NUM_OPS; op++) {
+    double ref[2] = {
+        mem_median(&MEM_NS(op, BENCH_BACKING_ALIGNED, 0), num_of_iterations),
+        mem_median(&MEM_NS(op, BENCH_BACKING_COUNT + BENCH_BACKING_ALIGNED, 0),
+                   num_of_iterations)};
+    for (int col = 0; col < MEM_COLS; col++) {
+      double med = mem_median(&MEM_NS(op, col, 0), num_of_iterations);
+      int is_bit_t = mem_col_is_bit_t(col);
+      int k = mem_col_backing(col);
+      char backing[32] = "library";
+      if (k >= 0 &&
+          strcmp(mem_obtained(&operands[k].buf[0]), bench_backing_names[k]))
+        snprintf(backing, sizeof backing, "%s>%s", bench_backing_names[k],
+                 mem_obtained(&operands[k].buf[0]));
+      else if (k >= 0)
+        snprintf(backing, sizeof backing, "%s", bench_backing_names[k]);
+      printf("%-8s %-11s %-14s %12.1f %+8.1f%%\n",
+             is_bit_t ? "Bit_T" : "CBitset", mem_op_names[op], backing, med,
+             100.0 * (med / ref[is_bit_t] - 1.0));
+    }
+  }
+#undef MEM_NS
+  printf("Results written to %s\n", outfile);
+
+  free(ns);
+  for (int k = 0; k < BENCH_BACKING_COUNT; k++) {
+    mem_operands_free(&operands[k]);
+  }
+  bitset_free(lib_b1);
+  bitset_free(lib_b2);
+  Bit_free(&bit_b1);
+  Bit_free(&bit_b2);
+  free_random_indices();
+  return 0;
+}
+
+/******************************************************************************
+
+* Workload dataset
+
+******************************************************************************/
+
+// `./benchmark dataset` runs the index generators once and stores their output
+// in a file (layout in benchmark_helper.h) together with the two operand
+// bitmaps of PopCount/Inter/InterCount. Setting BENCH_DATASET to such a file
+// makes the main benchmark and the memory subcommand map it read-only and use
+// the index arrays and, for CBitset and Bit_T, the operand bitmaps in place.
+// bench_bit_vector_cpan.pl -dataset builds its fills from the same index
+// arrays and its operands from the same bitmaps, so both languages see
+// identical inputs.
+
+typedef struct dataset_part {
+  bench_dataset_kind_t kind;
+  uint32_t elem_size;
+  uint64_t count;
+  const void *data;
+} dataset_part_t;
+
+// Words in an operand bitmap section: whole 64-bit words for bitveclen bits,
+// padded to Bit_buffer_size() so that Bit_load can wrap the section in place.
+static uint64_t dataset_words(int bitveclen) {
+  uint64_t words = ((uint64_t)bitveclen + 63) / 64;
+  uint64_t bit_t = ((uint64_t)Bit_buffer_size(bitveclen) + 7) / 8;
+  return words > bit_t ? words : bit_t;
+}
+
+static uint64_t *dataset_bitmap(const uint32_t *idx, int n, int bitveclen) {
+  uint64_t *words =
+      (uint64_t *)calloc((size_t)dataset_words(bitveclen), sizeof(uint64_t));
+  if (!words)
+    return NULL;
+  for (int i = 0; i < n; i++) {
+    words[idx[i] / 64] |= UINT64_C(1) << (idx[i] % 64);
+  }
+  return words;
+}
+
+// ./benchmark dataset <bitveclen> [seed]
+int run_dataset(int argc, char *argv[]) {
+  if (argc != 3 && argc != 4) {
+    puts("Usage: ./benchmark dataset <bitveclen> [seed]");
+    return 1;
+  }
+  int bitveclen = atoi(argv[2]);
+  g_seed = (argc == 4) ? (unsigned int)strtoul(argv[3], NULL, 10) : 100u;
+  assert(bitveclen > 0);
+
+  char outfile[512];
+  snprintf(outfile, sizeof outfile, "datasets/dataset_Length%d_Seed%u.bin",
+           bitveclen, g_seed);
+  mkdir("datasets", 0755);
+
+  init_random_indices(bitveclen, bitveclen / 10);
+  init_clustered_indices(bitveclen, bitveclen / 10);
+  uint64_t nwords = dataset_words(bitveclen);
+  // Every binary benchmark intersects a set with an identical copy of it, so
+  // both operands hold the bits of RAND_IDX, in separate memory.
+  uint64_t *op_a =
+      dataset_bitmap(g_rand_indices_u32, g_rand_indices_len, bitveclen);
+  uint64_t *op_b =
+      dataset_bitmap(g_rand_indices_u32, g_rand_indices_len, bitveclen);
+  assert(op_a != NULL && op_b != NULL);
+
+  const dataset_part_t parts[] = {
+      {BENCH_DATASET_RAND_IDX, sizeof(uint32_t),
+       (uint64_t)g_rand_indices_len, g_rand_indices_u32},
+      {BENCH_DATASET_CLUST_IDX, sizeof(uint32_t),
+       (uint64_t)g_clust_indices_len, g_clust_indices_u32},
+      {BENCH_DATASET_OPERAND_A, sizeof(uint64_t), nwords, op_a},
+      {BENCH_DATASET_OPERAND_B, sizeof(uint64_t), nwords, op_b},
+  };
+  enum { NPARTS = sizeof parts / sizeof parts[0] };
+
+  bench_dataset_header_t h;
+  memset(&h, 0, sizeof h);
+  memcpy(h.magic, BENCH_DATASET_MAGIC, sizeof h.magic);
+  h.version = BENCH_DATASET_VERSION;
+  h.endian = BENCH_DATASET_ENDIAN;
+  h.bitveclen = (uint64_t)bitveclen;
+  h.seed = g_seed;
+  h.nsections = NPARTS;
+  bench_dataset_section_t sec[NPARTS];
+  uint64_t offset = sizeof h + sizeof sec;
+  for (int i = 0; i < NPARTS; i++) {
+    offset = (offset + BENCH_DATASET_ALIGN - 1) / BENCH_DATASET_ALIGN *
+             BENCH_DATASET_ALIGN;
+    sec[i].kind = (uint32_t)parts[i].kind;
+    sec[i].elem_size = parts[i].elem_size;
+    sec[i].count = parts[i].count;
+    sec[i].offset = offset;
+    offset += parts[i].count * parts[i].elem_size;
+  }
+
+  FILE *f = fopen(outfile, "wb");
+  if (!f) {
+    fprintf(stderr, "Error opening file %s for writing\n", outfile);
+    return 1;
+  }
+  static const char zeros[BENCH_DATASET_ALIGN] = {0};
+  int ok = fwrite(&h, sizeof h, 1, f) == 1 && fwrite(sec, sizeof sec, 1, f) == 1;
+  uint64_t pos = sizeof h + sizeof sec;
+  for (int i = 0; ok && i < NPARTS; i++) {
+    ok = fwrite(zeros, 1, (size_t)(sec[i].offset - pos), f) ==
+             (size_t)(sec[i].offset - pos) &&
+         fwrite(parts[i].data, parts[i].elem_size, (size_t)parts[i].count,
+                f) == (size_t)parts[i].count;
+    pos = sec[i].offset + sec[i].count * sec[i].elem_size;
+  }
+  ok = fclose(f) == 0 && ok;
+  free(op_a);
+  free(op_b);
+  free_random_indices();
+  if (!ok) {
+    fprintf(stderr, "Error writing %s\n", outfile);
+    remove(outfile);
+    return 1;
+  }
+  printf("Dataset for bit length %d, seed %u written to %s (%llu bytes)\n",
+         bitveclen, g_seed, outfile, (unsigned long long)pos);
+  return 0;
+}
+
+// Maps the dataset named by BENCH_DATASET, if any. Returns -1 if it cannot be
+// used for this bit length: wrong length, an index out of range, or an
+// operand bitmap that is not the bitmap of RAND_IDX. CRoaring and the sorted
+// arrays build their operands from RAND_IDX while CBitset and Bit_T read the
+// bitmaps in place, so the two must agree.
+static int open_dataset(int bitveclen) {
+  const char *path = getenv("BENCH_DATASET");
+  if (!path || !*path)
+    return 0;
+  if (bench_dataset_open(&g_dataset, path) != 0)
+    return -1;
+  const char *why = NULL;
+  if (g_dataset.header->bitveclen != (uint64_t)bitveclen)
+    why = "was generated for a different bit length";
+  const bench_dataset_kind_t idx_kinds[2] = {BENCH_DATASET_RAND_IDX,
+                                             BENCH_DATASET_CLUST_IDX};
+  const uint32_t *rand_idx = NULL;
+  uint64_t nrand = 0;
+  for (int c = 0; !why && c < 2; c++) {
+    uint64_t n = 0;
+    const uint32_t *idx = (const uint32_t *)bench_dataset_get(
+        &g_dataset, idx_kinds[c], sizeof(uint32_t), &n);
+    if (!idx || n > INT32_MAX) {
+      why = "lacks an index array";
+      break;
+    }
+    for (uint64_t i = 0; i < n; i++) {
+      if (idx[i] >= (uint32_t)bitveclen) {
+        why = "has an index out of range";
+        break;
+      }
+    }
+    if (c == 0) {
+      rand_idx = idx;
+      nrand = n;
+    }
+  }
+  uint64_t *expect =
+      why ? NULL : dataset_bitmap(rand_idx, (int)nrand, bitveclen);
+  if (!why && !expect)
+    why = "cannot be checked (out of memory)";
+  const bench_dataset_kind_t op_kinds[2] = {BENCH_DATASET_OPERAND_A,
+                                            BENCH_DATASET_OPERAND_B};
+  for (int c = 0; !why && c < 2; c++) {
+    uint64_t nwords = 0;
+    const uint64_t *words = (const uint64_t *)bench_dataset_get(
+        &g_dataset, op_kinds[c], sizeof(uint64_t), &nwords);
+    if (!words || nwords != dataset_words(bitveclen))
+      why = "lacks an operand bitmap";
+    else if (memcmp(expect, words, (size_t)nwords * sizeof(uint64_t)) != 0)
+      why = "has an operand bitmap that does not match its indices";
+  }
+  free(expect);
+  if (why) {
+    fprintf(stderr, "Dataset %s %s\n", path, why);
+    bench_dataset_close(&g_dataset);
+    return -1;
+  }
+  g_seed = (unsigned int)g_dataset.header->seed;
+  printf("Using dataset %s (seed %u)\n", path, g_seed);
+  return 0;
+}
+
+/*****************************************************************************/
+
+// create a CRoaring, a Cbitset, a Bit_T and a sorted array, set half the bits,
+// and count the number of set bits
+void test_bit_funcs(int bitveclen) {
+  // CRoaring
+  roaring_bitmap_t *r1 = roaring_bitmap_create_with_capacity(bitveclen);
+  roaring_bitmap_t *r2 = roaring_bitmap_create_with_capacity(bitveclen);
+  int *arr = (int *)calloc((bitveclen / 2), sizeof(int));
+  assert(r1 != NULL);
+  for (int i = 0; i < bitveclen / 2; i++) {
+    roaring_bitmap_add(r1, i);
+    arr[i] = i;
+  }
+  uint64_t count1 = roaring_bitmap_get_cardinality(r1);
+  roaring_bitmap_add_many(r2, bitveclen / 2, (uint32_t *)arr);
+  uint64_t countr2 = roaring_bitmap_get_cardinality(r2);
+  free(arr);
+  roaring_bitmap_free(r1);
+  roaring_bitmap_free(r2);
+  // CBitset
+  bitset_t *b1 = bitset_create_with_capacity(bitveclen);
+  assert(b1 != NULL);
+  for (int i = 0; i < bitveclen / 2; i++) {
+    bitset_set(b1, i);
+  }
+  uint64_t count2 = bitset_count(b1);
+  bitset_free(b1);
+
+  // Bit_T
+  Bit_T b2 = Bit_new(bitveclen);
+  assert(b2 != NULL);
+  for (int i = 0; i < bitveclen / 2; i++) {
+    Bit_bset(b2, i);
+  }
+  uint64_t count3 = Bit_count(b2);
+  Bit_free(&b2);
+
+  // Sorted array; also cross-check the three intersection kernels
+  uint32_t *ids = (uint32_t *)malloc(sizeof(uint32_t) * (bitveclen / 2 + 1));
+  sorted_ids_t *s1 = sorted_ids_new(bitveclen / 2);
+  assert(ids != NULL && s1 != NULL);
+  for (int i = 0; i < bitveclen / 2; i++) {
+    ids[bitveclen / 2 - 1 - i] = (uint32_t)i; // reversed, to exercise the sort
+  }
+  sorted_ids_fill(s1, ids, bitveclen / 2);
+  uint64_t count4 = (uint64_t)s1->n;
+  assert((uint64_t)sorted_ids_count(s1) == count4);
+  assert(sorted_ids_inter_count(s1, s1) == count4);
+  assert(intersection_uint32_card(s1->ids, (size_t)s1->n, s1->ids,
+                                  (size_t)s1->n) == count4);
+  assert(sorted_gallop_card(s1->ids, (size_t)s1->n, s1->ids,
+                            (size_t)s1->n) == count4);
+  free(ids);
+  sorted_ids_free(s1);
+
+  // Verify counts are equal
+  assert(count1 == count2 && count2 == count3 && count3 == countr2 &&
+         count3 == count4);
+}
+// Benchmarking helper functions
+
+// Registers a benchmark; it is executed later by run_schedule.
+void schedule_benchmark(benchmark_result_t *results, char *approach,
+                        int num_results, benchmark_fn_t func) {
+
+  strncpy(results->approach, approach, sizeof(results->approach) - 1);
+
+  results->number_of_iterations = num_results;
+  results->time_elapsed = (double *)malloc(num_results * sizeof(double));
+  results->func = func;
+}
+
+// splitmix64; kept separate from rand() so that shuffling the schedule does
+// not perturb the data generators that reseed with srand(g_seed).
+static uint64_t schedule_next(uint64_t *state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+static void schedule_shuffle(schedule_entry_t *e, int n, uint64_t *state) {
+  for (int i = n - 1; i > 0; i--) {
+    int j = (int)(schedule_next(state) % (uint64_t)(i + 1));
+    schedule_entry_t tmp = e[i];
+    e[i] = e[j];
+    e[j] = tmp;
+  }
+}
+
+// Runs every registered repetition in the order given by BENCH_SCHEDULE
+// (sequential, shuffle or block; seeded by BENCH_SCHEDULE_SEED, default the
+// data seed) and records the execution order with timestamps in outfile.
+// Parse BENCH_SCHEDULE (unset means sequential); unknown values are an error
+// rather than a silent fallback, so a typo cannot pass as a mixed order.
+int schedule_kind_from_env(schedule_kind_t *kind) {
+  const char *env = getenv("BENCH_SCHEDULE");
+  if (!env || strcmp(env, "sequential") == 0)
+    *kind = SCHEDULE_SEQUENTIAL;
+  else if (strcmp(env, "shuffle") == 0)
+    *kind = SCHEDULE_SHUFFLE;
+  else if (strcmp(env, "block") == 0)
+    *kind = SCHEDULE_BLOCK;
+  else {
+    fprintf(stderr,
+            "Unknown BENCH_SCHEDULE '%s' (expected sequential, shuffle or "
+            "block)\n",
+            env);
+    return -1;
+  }
+  return 0;
+}
+
+void run_schedule(benchmark_result_t *results, int num_results, int bitveclen,
+                  int batch_size, const char *outfile) {
+  const char *seed_env = getenv("BENCH_SCHEDULE_SEED");
+  schedule_kind_t kind;
+  if (schedule_kind_from_env(&kind) != 0)
+    exit(EXIT_FAILURE);
+  uint64_t state =
+      seed_env ? strtoull(seed_env, NULL, 10) : (uint64_t)g_seed;
+
+  int total = 0;
+  for (int t = 0; t < num_results; t++) {
+    if (results[t].func)
+      total += results[t].number_of_iterations;
+  }
+  schedule_entry_t *order =
+      (schedule_entry_t *)calloc((size_t)total, sizeof(schedule_entry_t));
+  assert(total == 0 || order != NULL);
+
+  // Sequential layout, or round-major (iteration, test) for block schedules
+  int n = 0;
+  if (kind == SCHEDULE_BLOCK) {
+    int max_iter = 0;
+    for (int t = 0; t < num_results; t++) {
+      if (results[t].number_of_iterations > max_iter)
+        max_iter = results[t].number_of_iterations;
+    }
+    for (int it = 0; it < max_iter; it++) {
+      int round_start = n;
+      for (int t = 0; t < num_results; t++) {
+        if (results[t].func && it < results[t].number_of_iterations) {
+          order[n].test = t;
+          order[n].iteration = it;
+          n++;
+        }
+      }
+      schedule_shuffle(order + round_start, n - round_start, &state);
+    }
+  } else {
+    for (int t = 0; t < num_results; t++) {
+      if (!results[t].func)
+        continue;
+      for (int it = 0; it < results[t].number_of_iterations; it++) {
+        order[n].test = t;
+        order[n].iteration = it;
+        n++;
+      }
+    }
+    if (kind == SCHEDULE_SHUFFLE)
+      schedule_shuffle(order, n, &state);
+  }
+
+  struct timespec t0, now;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (int i = 0; i < n; i++) {
+    benchmark_result_t *r = &results[order[i].test];
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    order[i].start = timeDiff(&now, &t0);
+    order[i].elapsed = r->func(bitveclen, batch_size);
+    r->time_elapsed[order[i].iteration] = order[i].elapsed;
+  }
+
+  FILE *f = fopen(outfile, "w");
+  if (!f) {
+    fprintf(stderr, "Error opening file %s for writing\n", outfile);
+  } else {
+    fprintf(f, "order,schedule,approach,iteration,start_s,elapsed_s\n");
+    for (int i = 0; i < n; i++) {
+      fprintf(f, "%d,%s,%s,%d,%.9f,%.9e\n", i + 1,
+              kind == SCHEDULE_SHUFFLE ? "shuffle"
+              : kind == SCHEDULE_BLOCK ? "block"
+                                       : "sequential",
+              results[order[i].test].approach, order[i].iteration + 1,
+              order[i].start, order[i].elapsed);
+    }
+    fclose(f);
+  }
+  free(order);
+}
+
+void save_csv(benchmark_result_t *results, int num_results,
+              const char *outfile) {
+  FILE *f = fopen(outfile, "w");
+  if (!f) {
+    fprintf(stderr, "Error opening file %s for writing\n", outfile);
+    return;
+  }
+
+  // Write header i.e. the approach strings
+  for (int i = 0; i < num_results - 1; i++) {
+    fprintf(f, "%s,", results[i].approach);
+  }
+  fprintf(f, "%s\n", results[num_results - 1].approach);
+
+  // Write data
+  for (int j = 1; j <= results[0].number_of_iterations; j++) {
+    for (int i = 0; i < num_results - 1; i++) {
+      fprintf(f, "%.9e,", results[i].time_elapsed[j - 1]);
+    }
+    fprintf(f, "%.9e\n", results[num_results - 1].time_elapsed[j - 1]);
+  }
+
+  fclose(f);
+}
+
+// Long-format companion to save_csv: one row per approach and iteration with
+// seconds per batch, ns/op and TSC cycles/op (skipped tests are omitted).
+void save_perop_csv(benchmark_result_t *results, int num_results,
+                    int batch_size, const char *outfile) {
+  FILE *f = fopen(outfile, "w");
+  if (!f) {
+    fprintf(stderr, "Error opening file %s for writing\n", outfile);
+    return;
+  }
+
+  fprintf(f, "approach,iteration,timer,seconds,ns_per_op,cycles_per_op\n");
+  for (int i = 0; i < num_results; i++) {
+    for (int j = 0; j < results[i].number_of_iterations; j++) {
+      double t = results[i].time_elapsed[j];
+      if (t < 0.0)
+        continue;
+      fprintf(f, "%s,%d,%s,%.9e,%lf,%lf\n", results[i].approach, j + 1,
+              g_timer.kind == BENCH_TIMER_TSC ? "tsc" : "clock", t,
+              bench_ns_per_op(t, batch_size),
+              bench_cycles_per_op(t, batch_size));
+    }
+  }
+
+  fclose(f);
+}
+
+// Returns a pointer to a static array of length == bitveclen.
+// Each entry is a random integer in [0, bitveclen-1], generated
+// reproducibly from g_seed.
+static void init_random_indices(int bitveclen, int length_array) {
+  if (bitveclen <= 0 || length_array <= 0) {
+    return;
+  }
+
+  // Indices from the mapped dataset are used in place. The mapping is
+  // read-only; int and uint32_t share the representation of these
+  // non-negative values, so both views alias it. Only the 64-bit copy that
+  // CRoaring64 needs is materialized.
+  if (g_dataset.base) {
+    uint64_t n = 0;
+    const uint32_t *idx = (const uint32_t *)bench_dataset_get(
+        &g_dataset, BENCH_DATASET_RAND_IDX, sizeof(uint32_t), &n);
+    free(g_rand_indices_u64);
+    g_rand_indices_u64 = (uint64_t *)calloc((size_t)n + 1, sizeof(uint64_t));
+    assert(idx != NULL && g_rand_indices_u64 != NULL);
+    g_rand_indices = (int *)idx;
+    g_rand_indices_u32 = (uint32_t *)idx;
+    for (uint64_t i = 0; i < n; i++) {
+      g_rand_indices_u64[i] = (uint64_t)idx[i];
+    }
+    g_rand_indices_len = (int)n;
+    for (int k = 0; k < 2; k++) {
+      uint64_t nwords = 0;
+      g_operand[k] = (const uint64_t *)bench_dataset_get(
+          &g_dataset,
+          k == 0 ? BENCH_DATASET_OPERAND_A : BENCH_DATASET_OPERAND_B,
+          sizeof(uint64_t), &nwords);
+      assert(g_operand[k] != NULL);
+    }
+    g_indices_mapped = 1;
+    return;
+  }
+
+  if (g_rand_indices == NULL || g_rand_indices_len != length_array) {
+    unsigned int *tmp =
+        (int *)calloc((size_t)length_array, sizeof(unsigned int));
+    uint32_t *tmp_u32 =
+        (uint32_t *)calloc((size_t)length_array, sizeof(uint32_t));
+    uint64_t *tmp_u64 =
+        (uint64_t *)calloc((size_t)length_array, sizeof(uint64_t));
+    if (!tmp || !tmp_u32 || !tmp_u64) {
+      free(g_rand_indices);
+      free(g_rand_indices_u32);
+      free(g_rand_indices_u64);
+      g_rand_indices = NULL;
+      g_rand_indices_len = 0;
+      return;
+    }
+    g_rand_indices = tmp;
+    g_rand_indices_u32 = tmp_u32;
+    g_rand_indices_u64 = tmp_u64;
+    g_rand_indices_len = length_array;
+  }
+
+  srand(g_seed);
+  for (int i = 0; i < length_array; i++) {
+    g_rand_indices[i] = rand() % (bitveclen / 2);
+    g_rand_indices_u32[i] = (uint32_t)g_rand_indices[i];
+    g_rand_indices_u64[i] = (uint64_t)g_rand_indices[i];
+  }
+}
+
+// Fills g_clust_indices with length_array positions laid out as runs of
+// CLUSTER_RUN_LEN consecutive bits (shorter if bitveclen is small), each run
+// starting at a reproducible random offset.
+static void init_clustered_indices(int bitveclen, int length_array) {
+  if (bitveclen <= 0 || length_array <= 0) {
+    return;
+  }
+
+  if (g_dataset.base) {
+    uint64_t n = 0;
+    const uint32_t *idx = (const uint32_t *)bench_dataset_get(
+        &g_dataset, BENCH_DATASET_CLUST_IDX, sizeof(uint32_t), &n);
+    assert(idx != NULL);
+    g_clust_indices = (int *)idx;
+    g_clust_indices_u32 = (uint32_t *)idx;
+    g_clust_indices_len = (int)n;
+    g_indices_mapped = 1;
+    return;
+  }
+
+  free(g_clust_indices);
+  free(g_clust_indices_u32);
+  g_clust_indices = (int *)calloc((size_t)length_array, sizeof(int));
+  g_clust_indices_u32 =
+      (uint32_t *)calloc((size_t)length_array, sizeof(uint32_t));
+  if (!g_clust_indices || !g_clust_indices_u32) {
+    free(g_clust_indices);
+    free(g_clust_indices_u32);
+    g_clust_indices = NULL;
+    g_clust_indices_u32 = NULL;
+    g_clust_indices_len = 0;
+    return;
+  }
+  g_clust_indices_len = length_array;
+
+  int run_len = CLUSTER_RUN_LEN < bitveclen ? CLUSTER_RUN_LEN : bitveclen;
+  srand(g_seed);
+  int i = 0;
+  while (i < length_array) {
+    int start = rand() % (bitveclen - run_len + 1);
+    for (int j = 0; j < run_len && i < length_array; j++, i++) {
+      g_clust_indices[i] = start + j;
+      g_clust_indices_u32[i] = (uint32_t)(start + j);
+    }
+  }
+}
+
+void free_random_indices(void) {
+  if (!g_indices_mapped) {
+    free(g_rand_indices);
+    free(g_rand_indices_u32);
+    free(g_clust_indices);
+    free(g_clust_indices_u32);
+  }
   g_rand_indices = NULL;
-  free(g_rand_indices_u32);
   g_rand_indices_u32 = NULL;
   free(g_rand_indices_u64);
   g_rand_indices_u64 = NULL;
   g_rand_indices_len = 0;
+  g_clust_indices = NULL;
+  g_clust_indices_u32 = NULL;
+  g_clust_indices_len = 0;
+  g_operand[0] = g_operand[1] = NULL;
+  g_indices_mapped = 0;
+  bench_dataset_close(&g_dataset);
 }
\ No newline at end of file
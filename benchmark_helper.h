@@ -1,12 +1,130 @@
 #include <assert.h>
+#include <fcntl.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+// Optimization barriers. BENCH_ESCAPE makes the compiler assume the pointed-to
+// object may be read or modified (so calls on it cannot be hoisted out of the
+// timed loop); BENCH_DO_NOT_OPTIMIZE makes a computed value observable without
+// forcing it through memory as a volatile local would.
+#define BENCH_ESCAPE(p) __asm__ __volatile__("" : : "g"(p) : "memory")
+#define BENCH_DO_NOT_OPTIMIZE(v) __asm__ __volatile__("" : : "r"(v) : "memory")
+#define BENCH_CLOBBER() __asm__ __volatile__("" : : : "memory")
+
+// Timing backends; selected at runtime through the BENCH_TIMER environment
+// variable ("clock" = clock_gettime(CLOCK_MONOTONIC), "tsc" = serialized
+// rdtsc/rdtscp with a calibrated TSC frequency).
+typedef enum bench_timer_kind {
+  BENCH_TIMER_CLOCK = 0,
+  BENCH_TIMER_TSC = 1
+} bench_timer_kind_t;
+
+typedef struct bench_stamp {
+  struct timespec ts;
+  uint64_t tsc;
+} bench_stamp_t;
+
+typedef struct bench_timer {
+  bench_timer_kind_t kind;
+  double tsc_hz;      // calibrated TSC ticks per second (0 if unavailable)
+  double overhead_s;  // empty batch loop + timer call cost, in seconds
+} bench_timer_t;
+
+static bench_timer_t g_timer = {BENCH_TIMER_CLOCK, 0.0, 0.0};
+
+// Explicitly backed buffers for the memory experiments. hugetlb needs
+// reserved pages (vm.nr_hugepages); without them it falls back to thp, and
+// the backing actually obtained is recorded in the buffer. Whether the kernel
+// really used huge pages is read back from /proc/self/smaps after the buffer
+// has been faulted in.
+typedef enum bench_backing {
+  BENCH_BACKING_MALLOC = 0,
+  BENCH_BACKING_ALIGNED = 1,    // 64-byte (cache line) aligned
+  BENCH_BACKING_MISALIGNED = 2, // 8 bytes past a cache line boundary
+  BENCH_BACKING_THP = 3,        // 2 MB aligned mmap + madvise(MADV_HUGEPAGE)
+  BENCH_BACKING_HUGETLB = 4,    // mmap(MAP_HUGETLB)
+  BENCH_BACKING_COUNT = 5
+} bench_backing_t;
+
+#define BENCH_HUGE_PAGE (2u * 1024u * 1024u)
+
+typedef struct bench_buffer {
+  void *ptr;               // usable, zeroed memory of at least the request
+  void *base;              // what to hand back to free/munmap
+  size_t mapped;           // mmap length (0 for heap allocations)
+  bench_backing_t backing; // backing actually obtained
+  long huge_kb;            // huge-page kB of an mmap buffer, else -1
+} bench_buffer_t;
+
+// Workload dataset file shared by the C and Perl harnesses. Layout (native
+// byte order, checked through `endian`): the header, nsections section
+// entries, then the section payloads, each starting on a 64-byte boundary.
+// New section kinds can be added without changing the version; readers skip
+// kinds they do not know.
+#define BENCH_DATASET_MAGIC "BITBENCH"
+#define BENCH_DATASET_VERSION 1u
+#define BENCH_DATASET_ENDIAN 0x01020304u
+#define BENCH_DATASET_ALIGN 64u
+
+typedef enum bench_dataset_kind {
+  BENCH_DATASET_RAND_IDX = 1,  // uint32 uniform indices (FillHalf*, Inter*)
+  BENCH_DATASET_CLUST_IDX = 2, // uint32 clustered indices (*Clustered)
+  BENCH_DATASET_OPERAND_A = 3, // uint64 words, first operand of PopCount/Inter*
+  BENCH_DATASET_OPERAND_B = 4  // uint64 words, second operand of Inter*
+} bench_dataset_kind_t;
+
+typedef struct bench_dataset_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;
+  uint64_t bitveclen;
+  uint64_t seed;
+  uint32_t nsections;
+  uint32_t reserved;
+} bench_dataset_header_t; // 40 bytes
+
+typedef struct bench_dataset_section {
+  uint32_t kind;
+  uint32_t elem_size; // bytes per element
+  uint64_t count;     // number of elements
+  uint64_t offset;    // from the start of the file
+} bench_dataset_section_t; // 24 bytes
+
+typedef struct bench_dataset {
+  void *base; // read-only mapping of the whole file, NULL when closed
+  size_t size;
+  const bench_dataset_header_t *header;
+  const bench_dataset_section_t *sections;
+} bench_dataset_t;
 
 double timeDiff(struct timespec *timeA_p, struct timespec *timeB_p);
 int get_cpu_model(char *out, size_t out_sz);
+void bench_timer_init(int batch_size);
+static inline void bench_timer_start(bench_stamp_t *stamp);
+static inline void bench_timer_stop(bench_stamp_t *stamp);
+static inline double bench_timer_elapsed(bench_stamp_t *end_p,
+                                         bench_stamp_t *start_p);
+int bench_buffer_alloc(bench_buffer_t *buf, size_t bytes,
+                       bench_backing_t backing);
+void bench_buffer_free(bench_buffer_t *buf);
+int bench_dataset_open(bench_dataset_t *ds, const char *path);
+const void *bench_dataset_get(const bench_dataset_t *ds,
+                              bench_dataset_kind_t kind, uint32_t elem_size,
+                              uint64_t *count);
+void bench_dataset_close(bench_dataset_t *ds);
 
 
 // Various functions
@@ -16,6 +134,314 @@ double timeDiff(struct timespec *timeA_p, struct timespec *timeB_p) {
          1.0e9;
 }
 
+// Start stamp: lfence keeps earlier instructions from drifting into the
+// measured region, the trailing lfence keeps the region from starting early.
+static inline void bench_timer_start(bench_stamp_t *stamp) {
+#if BENCH_HAVE_TSC
+  if (g_timer.kind == BENCH_TIMER_TSC) {
+    _mm_lfence();
+    stamp->tsc = __rdtsc();
+    _mm_lfence();
+    return;
+  }
+#endif
+  clock_gettime(CLOCK_MONOTONIC, &stamp->ts);
+}
+
+// Stop stamp: rdtscp waits for the measured region to retire, the lfence keeps
+// later instructions from being hoisted above the read.
+static inline void bench_timer_stop(bench_stamp_t *stamp) {
+#if BENCH_HAVE_TSC
+  if (g_timer.kind == BENCH_TIMER_TSC) {
+    unsigned int aux;
+    stamp->tsc = __rdtscp(&aux);
+    _mm_lfence();
+    return;
+  }
+#endif
+  clock_gettime(CLOCK_MONOTONIC, &stamp->ts);
+}
+
+// Raw elapsed seconds between two stamps of the active backend.
+static inline double bench_timer_raw(bench_stamp_t *end_p,
+                                     bench_stamp_t *start_p) {
+  if (g_timer.kind == BENCH_TIMER_TSC)
+    return (double)(end_p->tsc - start_p->tsc) / g_timer.tsc_hz;
+  return timeDiff(&end_p->ts, &start_p->ts);
+}
+
+// Elapsed seconds with the calibrated loop/timer overhead removed.
+static inline double bench_timer_elapsed(bench_stamp_t *end_p,
+                                         bench_stamp_t *start_p) {
+  double t = bench_timer_raw(end_p, start_p) - g_timer.overhead_s;
+  return t > 0.0 ? t : 0.0;
+}
+
+// Measure TSC ticks against CLOCK_MONOTONIC over ~50ms.
+static double bench_calibrate_tsc(void) {
+#if BENCH_HAVE_TSC
+  struct timespec t0, t1;
+  unsigned int aux;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  uint64_t c0 = __rdtscp(&aux);
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+  } while (timeDiff(&t1, &t0) < 0.05);
+  uint64_t c1 = __rdtscp(&aux);
+  return (double)(c1 - c0) / timeDiff(&t1, &t0);
+#else
+  return 0.0;
+#endif
+}
+
+// TSC ticks only convert to seconds at a fixed rate if the counter neither
+// follows frequency scaling (constant_tsc) nor stops in deep C-states
+// (nonstop_tsc). Returns 1 if /proc/cpuinfo lists both flags.
+static int bench_tsc_invariant(void) {
+  FILE *f = fopen("/proc/cpuinfo", "r");
+  if (!f)
+    return 0;
+  char line[4096];
+  int ok = 0;
+  while (fgets(line, sizeof line, f)) {
+    if (strncmp(line, "flags", 5) == 0) {
+      ok = strstr(line, " constant_tsc") != NULL &&
+           strstr(line, " nonstop_tsc") != NULL;
+      break;
+    }
+  }
+  fclose(f);
+  return ok;
+}
+
+// Select the backend from BENCH_TIMER, calibrate the TSC and measure the cost
+// of an empty batch loop of batch_size iterations (minimum over 64 trials).
+void bench_timer_init(int batch_size) {
+  const char *env = getenv("BENCH_TIMER");
+  g_timer.kind = BENCH_TIMER_CLOCK;
+  g_timer.tsc_hz = bench_calibrate_tsc();
+  g_timer.overhead_s = 0.0;
+  if (env && strcmp(env, "tsc") == 0) {
+    if (!BENCH_HAVE_TSC || g_timer.tsc_hz <= 0.0)
+      fprintf(stderr, "TSC timer unavailable; using clock_gettime\n");
+    else if (!bench_tsc_invariant())
+      fprintf(stderr, "TSC lacks constant_tsc/nonstop_tsc; using "
+                      "clock_gettime\n");
+    else
+      g_timer.kind = BENCH_TIMER_TSC;
+  }
+
+  double best = -1.0;
+  for (int trial = 0; trial < 64; trial++) {
+    bench_stamp_t start_time, end_time;
+    bench_timer_start(&start_time);
+    for (int i = 0; i < batch_size; i++) {
+      BENCH_DO_NOT_OPTIMIZE(i);
+    }
+    bench_timer_stop(&end_time);
+    double t = bench_timer_raw(&end_time, &start_time);
+    if (best < 0.0 || t < best)
+      best = t;
+  }
+  g_timer.overhead_s = best;
+}
+
+// Convert seconds per batch into ns/op and TSC cycles/op (NaN without a TSC).
+static inline double bench_ns_per_op(double seconds, int batch_size) {
+  return seconds * 1.0e9 / batch_size;
+}
+
+static inline double bench_cycles_per_op(double seconds, int batch_size) {
+  if (g_timer.tsc_hz <= 0.0)
+    return NAN;
+  return seconds * g_timer.tsc_hz / batch_size;
+}
+
+// Only the 2 MB pages that hold the buffer are advised. The unadvised slack
+// around them keeps the kernel from merging the advised range with a
+// neighbouring thp buffer, so smaps reports it as a mapping of its own.
+static int bench_map_thp(bench_buffer_t *buf, size_t bytes) {
+  size_t pages = (bytes + BENCH_HUGE_PAGE - 1) / BENCH_HUGE_PAGE *
+                 BENCH_HUGE_PAGE;
+  size_t len = pages + BENCH_HUGE_PAGE;
+  void *base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    return -1;
+  uintptr_t p = ((uintptr_t)base + BENCH_HUGE_PAGE - 1) &
+                ~(uintptr_t)(BENCH_HUGE_PAGE - 1);
+#ifdef MADV_HUGEPAGE
+  if (madvise((void *)p, pages, MADV_HUGEPAGE) != 0)
+    fprintf(stderr, "madvise(MADV_HUGEPAGE) failed; thp buffer may use "
+                    "4 KB pages\n");
+#endif
+  buf->ptr = (void *)p;
+  buf->base = base;
+  buf->mapped = len;
+  buf->backing = BENCH_BACKING_THP;
+  return 0;
+}
+
+// kB backed by huge pages (AnonHugePages for THP, Private/Shared_Hugetlb for
+// hugetlbfs) in the mapping that contains p, or -1 if smaps is unreadable.
+static long bench_huge_kb(const void *p) {
+  FILE *f = fopen("/proc/self/smaps", "r");
+  if (!f)
+    return -1;
+  char line[512];
+  int inside = 0;
+  long kb = -1;
+  while (fgets(line, sizeof line, f)) {
+    unsigned long lo, hi, v;
+    if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {
+      if (inside)
+        break;
+      inside = (uintptr_t)p >= lo && (uintptr_t)p < hi;
+      if (inside)
+        kb = 0;
+    } else if (inside && (sscanf(line, "AnonHugePages: %lu kB", &v) == 1 ||
+                          sscanf(line, "Private_Hugetlb: %lu kB", &v) == 1 ||
+                          sscanf(line, "Shared_Hugetlb: %lu kB", &v) == 1)) {
+      kb += (long)v;
+    }
+  }
+  fclose(f);
+  return kb;
+}
+
+// Returns 0 on success. The memory is written once so that every page is
+// faulted in before any timing.
+int bench_buffer_alloc(bench_buffer_t *buf, size_t bytes,
+                       bench_backing_t backing) {
+  memset(buf, 0, sizeof *buf);
+  buf->backing = backing;
+  switch (backing) {
+  case BENCH_BACKING_MALLOC:
+    buf->base = buf->ptr = malloc(bytes);
+    break;
+  case BENCH_BACKING_ALIGNED:
+    if (posix_memalign(&buf->base, 64, bytes) == 0)
+      buf->ptr = buf->base;
+    break;
+  case BENCH_BACKING_MISALIGNED:
+    if (posix_memalign(&buf->base, 64, bytes + 64) == 0)
+      buf->ptr = (char *)buf->base + 8;
+    break;
+  case BENCH_BACKING_HUGETLB: {
+#ifdef MAP_HUGETLB
+    size_t len =
+        (bytes + BENCH_HUGE_PAGE - 1) / BENCH_HUGE_PAGE * BENCH_HUGE_PAGE;
+    void *base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED) {
+      buf->ptr = buf->base = base;
+      buf->mapped = len;
+      break;
+    }
+#endif
+    fprintf(stderr, "MAP_HUGETLB unavailable; falling back to thp\n");
+    if (bench_map_thp(buf, bytes) != 0)
+      return -1;
+    break;
+  }
+  case BENCH_BACKING_THP:
+    if (bench_map_thp(buf, bytes) != 0)
+      return -1;
+    break;
+  default:
+    return -1;
+  }
+  if (!buf->ptr)
+    return -1;
+  memset(buf->ptr, 0, bytes);
+  buf->huge_kb = buf->mapped ? bench_huge_kb(buf->ptr) : -1;
+  return 0;
+}
+
+void bench_buffer_free(bench_buffer_t *buf) {
+  if (buf->mapped)
+    munmap(buf->base, buf->mapped);
+  else
+    free(buf->base);
+  memset(buf, 0, sizeof *buf);
+}
+
+// Maps path read-only and validates the header and section table. Returns 0
+// on success; on failure prints the reason and returns -1.
+int bench_dataset_open(bench_dataset_t *ds, const char *path) {
+  memset(ds, 0, sizeof *ds);
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Cannot open dataset %s\n", path);
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      (size_t)st.st_size < sizeof(bench_dataset_header_t)) {
+    fprintf(stderr, "Dataset %s is truncated\n", path);
+    close(fd);
+    return -1;
+  }
+  void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    fprintf(stderr, "Cannot map dataset %s\n", path);
+    return -1;
+  }
+  const bench_dataset_header_t *h = (const bench_dataset_header_t *)base;
+  const char *why = NULL;
+  if (memcmp(h->magic, BENCH_DATASET_MAGIC, sizeof h->magic) != 0)
+    why = "not a benchmark dataset";
+  else if (h->endian != BENCH_DATASET_ENDIAN)
+    why = "written with a different byte order";
+  else if (h->version != BENCH_DATASET_VERSION)
+    why = "unsupported version";
+  else if (sizeof *h + (uint64_t)h->nsections *
+                           sizeof(bench_dataset_section_t) >
+           (uint64_t)st.st_size)
+    why = "section table is truncated";
+  const bench_dataset_section_t *sec = (const bench_dataset_section_t *)(h + 1);
+  for (uint32_t i = 0; !why && i < h->nsections; i++) {
+    if (sec[i].elem_size == 0 || sec[i].offset % BENCH_DATASET_ALIGN != 0 ||
+        sec[i].offset > (uint64_t)st.st_size ||
+        sec[i].count >
+            ((uint64_t)st.st_size - sec[i].offset) / sec[i].elem_size)
+      why = "section lies outside the file";
+  }
+  if (why) {
+    fprintf(stderr, "Dataset %s: %s\n", path, why);
+    munmap(base, (size_t)st.st_size);
+    return -1;
+  }
+  ds->base = base;
+  ds->size = (size_t)st.st_size;
+  ds->header = h;
+  ds->sections = sec;
+  return 0;
+}
+
+// Zero-copy pointer to the payload of the first section of `kind`, or NULL if
+// the file has none or its elements are not elem_size bytes.
+const void *bench_dataset_get(const bench_dataset_t *ds,
+                              bench_dataset_kind_t kind, uint32_t elem_size,
+                              uint64_t *count) {
+  for (uint32_t i = 0; i < ds->header->nsections; i++) {
+    const bench_dataset_section_t *sec = &ds->sections[i];
+    if (sec->kind == (uint32_t)kind && sec->elem_size == elem_size) {
+      *count = sec->count;
+      return (const char *)ds->base + sec->offset;
+    }
+  }
+  *count = 0;
+  return NULL;
+}
+
+void bench_dataset_close(bench_dataset_t *ds) {
+  if (ds->base)
+    munmap(ds->base, ds->size);
+  memset(ds, 0, sizeof *ds);
+}
+
 int get_cpu_model(char *out, size_t out_sz) {
   FILE *f = fopen("/proc/cpuinfo", "r");
   if (!f)
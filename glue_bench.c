@@ -0,0 +1,142 @@
+// Direct C reference timings for the glue-overhead benchmark
+// (bench_glue_overhead.pl). The Perl script hands over the path of the libbit
+// shared object that Bit::Set itself links against; the kernels are resolved
+// from that object with dlopen/dlsym so that C, XS and FFI all call exactly
+// the same code. Each glue_c_* function runs `reps` calls back-to-back in C
+// and returns the cost of one call in ns.
+#include "./c-libs/bit.h"
+#include "benchmark_helper.h"
+#include <dlfcn.h>
+
+typedef Bit_T (*bit_new_fn)(int);
+typedef void (*bit_free_fn)(Bit_T *);
+typedef int (*bit_get_fn)(Bit_T, int);
+typedef void (*bit_bset_fn)(Bit_T, int);
+typedef void (*bit_aset_fn)(Bit_T, int[], int);
+typedef int (*bit_inter_count_fn)(Bit_T, Bit_T);
+
+static void *g_libbit = NULL;
+static bit_new_fn p_Bit_new;
+static bit_free_fn p_Bit_free;
+static bit_get_fn p_Bit_get;
+static bit_bset_fn p_Bit_bset;
+static bit_aset_fn p_Bit_aset;
+static bit_inter_count_fn p_Bit_inter_count;
+
+int glue_open(const char *libpath, int reps);
+double glue_c_get(int bitveclen, int reps);
+double glue_c_bset(int bitveclen, int reps);
+double glue_c_aset(int bitveclen, int nidx, int reps);
+double glue_c_inter_count(int bitveclen, int reps);
+
+// Returns 0 on success, -1 if the library or one of the symbols is missing.
+int glue_open(const char *libpath, int reps) {
+  g_libbit = dlopen(libpath, RTLD_NOW | RTLD_GLOBAL);
+  if (!g_libbit) {
+    fprintf(stderr, "dlopen(%s): %s\n", libpath, dlerror());
+    return -1;
+  }
+  *(void **)&p_Bit_new = dlsym(g_libbit, "Bit_new");
+  *(void **)&p_Bit_free = dlsym(g_libbit, "Bit_free");
+  *(void **)&p_Bit_get = dlsym(g_libbit, "Bit_get");
+  *(void **)&p_Bit_bset = dlsym(g_libbit, "Bit_bset");
+  *(void **)&p_Bit_aset = dlsym(g_libbit, "Bit_aset");
+  *(void **)&p_Bit_inter_count = dlsym(g_libbit, "Bit_inter_count");
+  if (!p_Bit_new || !p_Bit_free || !p_Bit_get || !p_Bit_bset ||
+      !p_Bit_aset || !p_Bit_inter_count) {
+    fprintf(stderr, "libbit at %s lacks a required symbol\n", libpath);
+    return -1;
+  }
+  bench_timer_init(reps);
+  return 0;
+}
+
+double glue_c_get(int bitveclen, int reps) {
+  Bit_T b1 = p_Bit_new(bitveclen);
+  assert(b1 != NULL);
+  p_Bit_bset(b1, 2);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < reps; i++) {
+    BENCH_ESCAPE(b1);
+    int bit = p_Bit_get(b1, 2);
+    BENCH_DO_NOT_OPTIMIZE(bit);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  p_Bit_free(&b1);
+  return bench_ns_per_op(timeElapsed, reps);
+}
+
+double glue_c_bset(int bitveclen, int reps) {
+  Bit_T b1 = p_Bit_new(bitveclen);
+  assert(b1 != NULL);
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < reps; i++) {
+    BENCH_ESCAPE(b1);
+    p_Bit_bset(b1, 3);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  p_Bit_free(&b1);
+  return bench_ns_per_op(timeElapsed, reps);
+}
+
+// nidx sequential indices (wrapping at bitveclen), the same argument the Perl
+// side builds as an array ref.
+double glue_c_aset(int bitveclen, int nidx, int reps) {
+  Bit_T b1 = p_Bit_new(bitveclen);
+  int *indices = (int *)malloc(sizeof(int) * (size_t)nidx);
+  assert(b1 != NULL && indices != NULL);
+  for (int i = 0; i < nidx; i++) {
+    indices[i] = i % bitveclen;
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < reps; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(indices);
+    p_Bit_aset(b1, indices, nidx);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  free(indices);
+  p_Bit_free(&b1);
+  return bench_ns_per_op(timeElapsed, reps);
+}
+
+double glue_c_inter_count(int bitveclen, int reps) {
+  Bit_T b1 = p_Bit_new(bitveclen);
+  Bit_T b2 = p_Bit_new(bitveclen);
+  assert(b1 != NULL && b2 != NULL);
+  for (int i = 0; i < bitveclen / 2; i++) {
+    p_Bit_bset(b1, i);
+    p_Bit_bset(b2, i);
+  }
+
+  bench_stamp_t start_time, end_time;
+  double timeElapsed = 0;
+  bench_timer_start(&start_time);
+  for (int i = 0; i < reps; i++) {
+    BENCH_ESCAPE(b1);
+    BENCH_ESCAPE(b2);
+    int count = p_Bit_inter_count(b1, b2);
+    BENCH_DO_NOT_OPTIMIZE(count);
+  }
+  bench_timer_stop(&end_time);
+  timeElapsed = bench_timer_elapsed(&end_time, &start_time);
+
+  p_Bit_free(&b1);
+  p_Bit_free(&b2);
+  return bench_ns_per_op(timeElapsed, reps);
+}